@@ -0,0 +1,364 @@
+#include "BatchEvaluator.h"
+
+#include <cstring>
+
+#include "Engine.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CHECKERS_BATCH_X86
+#endif
+
+namespace
+{
+using Bitboard = Board::Bitboard;
+
+static_assert(Board::SIZE == 8, "the kernels assume one row per nibble of a 32-bit board");
+
+// Row r is bits 4r..4r+3, so even rows are the low nibble of each byte.
+constexpr Bitboard EVEN_ROWS = 0x0F0F0F0F;
+constexpr Bitboard ODD_ROWS = 0xF0F0F0F0;
+constexpr Bitboard FIRST_COLUMN = 0x11111111;
+constexpr Bitboard LAST_COLUMN = 0x88888888;
+constexpr Bitboard OWN_BACK_RANK = 0xF0000000;
+constexpr Bitboard ENEMY_BACK_RANK = 0x0000000F;
+constexpr Bitboard CENTER = 0x00066000;
+
+// Multiplying four byte-sized counts by this sums weight[b] * count[b] into
+// the top byte of the product. Nothing carries between bytes as long as the
+// counts are at most 4 (squares per row) and the weights at most 7.
+constexpr Bitboard byteWeights(Bitboard w0, Bitboard w1, Bitboard w2, Bitboard w3)
+{
+    return w0 << 24 | w1 << 16 | w2 << 8 | w3;
+}
+
+// Rows advanced, by row, for even rows (0, 2, 4, 6) and odd rows (1, 3, 5, 7).
+constexpr Bitboard OWN_EVEN_ADVANCE = byteWeights(7, 5, 3, 1);
+constexpr Bitboard OWN_ODD_ADVANCE = byteWeights(6, 4, 2, 0);
+constexpr Bitboard ENEMY_EVEN_ADVANCE = byteWeights(0, 2, 4, 6);
+constexpr Bitboard ENEMY_ODD_ADVANCE = byteWeights(1, 3, 5, 7);
+
+// The half turn of the board, which maps square s to square 31 - s.
+constexpr Bitboard rotate(Bitboard b)
+{
+    b = ((b >> 1) & 0x55555555) | ((b & 0x55555555) << 1);
+    b = ((b >> 2) & 0x33333333) | ((b & 0x33333333) << 2);
+    b = ((b >> 4) & 0x0F0F0F0F) | ((b & 0x0F0F0F0F) << 4);
+    b = ((b >> 8) & 0x00FF00FF) | ((b & 0x00FF00FF) << 8);
+    return (b >> 16) | (b << 16);
+}
+
+// Everything below is written once for V, which is either a Bitboard or a
+// vector of them: GCC and Clang vector types take the same operators lane by
+// lane, with scalars broadcast. The helpers are forced inline so they are
+// compiled for the instruction set of the kernel that uses them.
+#define CHECKERS_LANES [[gnu::always_inline]] inline
+
+template <typename V>
+CHECKERS_LANES V popcount(const V& bits)
+{
+    V x = bits - ((bits >> 1) & 0x55555555);
+    x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+    x = (x + (x >> 4)) & 0x0F0F0F0F;
+    return (x * 0x01010101) >> 24;
+}
+
+// Sum over rows of the row's weight times the pieces on it. Two popcount
+// steps leave the count of each row in its nibble.
+template <typename V>
+CHECKERS_LANES V weightedRows(const V& bits, Bitboard evenWeights, Bitboard oddWeights)
+{
+    V x = bits - ((bits >> 1) & 0x55555555);
+    x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+    return (((x & EVEN_ROWS) * evenWeights) >> 24) + ((((x >> 4) & EVEN_ROWS) * oddWeights) >> 24);
+}
+
+// One diagonal step of every square in x, as in Board.
+template <typename V>
+CHECKERS_LANES V upLeft(const V& x)
+{
+    return ((x & EVEN_ROWS) >> 4) | ((x & (ODD_ROWS & ~FIRST_COLUMN)) >> 5);
+}
+
+template <typename V>
+CHECKERS_LANES V upRight(const V& x)
+{
+    return ((x & (EVEN_ROWS & ~LAST_COLUMN)) >> 3) | ((x & ODD_ROWS) >> 4);
+}
+
+template <typename V>
+CHECKERS_LANES V downLeft(const V& x)
+{
+    return ((x & EVEN_ROWS) << 4) | ((x & (ODD_ROWS & ~FIRST_COLUMN)) << 3);
+}
+
+template <typename V>
+CHECKERS_LANES V downRight(const V& x)
+{
+    return ((x & (EVEN_ROWS & ~LAST_COLUMN)) << 5) | ((x & ODD_ROWS) << 4);
+}
+
+template <typename V>
+CHECKERS_LANES V load(const std::vector<Bitboard>& source, std::size_t index)
+{
+    V lanes;
+    std::memcpy(&lanes, source.data() + index, sizeof(V));
+    return lanes;
+}
+
+// Differences wrap around in unsigned lanes, which is exactly the two's
+// complement the signed outputs want.
+template <typename V>
+CHECKERS_LANES void store(std::vector<std::int32_t>& target, std::size_t index, const V& lanes)
+{
+    std::memcpy(target.data() + index, &lanes, sizeof(V));
+}
+
+template <typename V>
+CHECKERS_LANES void store(BatchEvaluator::Evaluations& out,
+                          std::size_t index,
+                          BatchEvaluator::Feature feature,
+                          const V& lanes)
+{
+    store(out.features[static_cast<std::size_t>(feature)], index, lanes);
+}
+
+// Evaluates positions [begin, end) in steps of one vector and returns where
+// it stopped; fewer than a vector's worth may be left over.
+template <typename V>
+CHECKERS_LANES std::size_t evaluateLanes(const BatchEvaluator::Positions& in,
+                                         std::size_t begin,
+                                         std::size_t end,
+                                         BatchEvaluator::Evaluations& out)
+{
+    using Feature = BatchEvaluator::Feature;
+    constexpr std::size_t LANES = sizeof(V) / sizeof(Bitboard);
+
+    std::size_t i = begin;
+    for (; i + LANES <= end; i += LANES)
+    {
+        const V own = load<V>(in.own, i);
+        const V enemy = load<V>(in.enemy, i);
+        const V kings = load<V>(in.kings, i);
+        const V ownKings = own & kings;
+        const V ownMen = own & ~kings;
+        const V enemyKings = enemy & kings;
+        const V enemyMen = enemy & ~kings;
+        const V occupied = own | enemy;
+        const V empty = ~occupied;
+
+        const V men = popcount(ownMen) - popcount(enemyMen);
+        const V kingCount = popcount(ownKings) - popcount(enemyKings);
+        const V advancement = weightedRows(ownMen, OWN_EVEN_ADVANCE, OWN_ODD_ADVANCE) -
+                              weightedRows(enemyMen, ENEMY_EVEN_ADVANCE, ENEMY_ODD_ADVANCE);
+        const V backRank = popcount(ownMen & OWN_BACK_RANK) - popcount(enemyMen & ENEMY_BACK_RANK);
+        const V center = popcount(own & CENTER) - popcount(enemy & CENTER);
+
+        // Men step forward only, kings either way.
+        const V ownMobility = popcount(upLeft(own) & empty) + popcount(upRight(own) & empty) +
+                              popcount(downLeft(ownKings) & empty) + popcount(downRight(ownKings) & empty);
+        const V enemyMobility = popcount(downLeft(enemy) & empty) + popcount(downRight(enemy) & empty) +
+                                popcount(upLeft(enemyKings) & empty) + popcount(upRight(enemyKings) & empty);
+
+        // Squares with a piece on them or anywhere ahead of them, for each
+        // direction of travel; a man is a runaway if neither square in front
+        // of it is one of those.
+        V blockedUp = occupied;
+        V blockedDown = occupied;
+        for (int row = 1; row < Board::SIZE; ++row)
+        {
+            blockedUp |= downLeft(blockedUp) | downRight(blockedUp);
+            blockedDown |= upLeft(blockedDown) | upRight(blockedDown);
+        }
+        const V runaways = popcount(ownMen & ~(downLeft(blockedUp) | downRight(blockedUp))) -
+                           popcount(enemyMen & ~(upLeft(blockedDown) | upRight(blockedDown)));
+
+        store(out.scores, i,
+              men * Engine::MAN_VALUE + kingCount * Engine::KING_VALUE + advancement * Engine::ADVANCE_BONUS +
+                  backRank * Engine::BACK_RANK_BONUS + center * Engine::CENTER_BONUS);
+        store(out, i, Feature::Men, men);
+        store(out, i, Feature::Kings, kingCount);
+        store(out, i, Feature::Advancement, advancement);
+        store(out, i, Feature::BackRank, backRank);
+        store(out, i, Feature::Center, center);
+        store(out, i, Feature::Mobility, ownMobility - enemyMobility);
+        store(out, i, Feature::Runaways, runaways);
+    }
+    return i;
+}
+
+std::size_t evaluateScalar(const BatchEvaluator::Positions& in,
+                           std::size_t begin,
+                           std::size_t end,
+                           BatchEvaluator::Evaluations& out)
+{
+    return evaluateLanes<Bitboard>(in, begin, end, out);
+}
+
+#ifdef CHECKERS_BATCH_X86
+using Vector4 = Bitboard __attribute__((vector_size(16)));
+using Vector8 = Bitboard __attribute__((vector_size(32)));
+
+// The helpers for 8 lanes return AVX vectors, so they are instantiated as AVX2
+// code like the kernel that uses them; built without AVX they would have an
+// ABI of their own, which GCC warns about.
+#pragma GCC push_options
+#pragma GCC target("avx2")
+template Vector8 popcount<Vector8>(const Vector8&);
+template Vector8 weightedRows<Vector8>(const Vector8&, Bitboard, Bitboard);
+template Vector8 upLeft<Vector8>(const Vector8&);
+template Vector8 upRight<Vector8>(const Vector8&);
+template Vector8 downLeft<Vector8>(const Vector8&);
+template Vector8 downRight<Vector8>(const Vector8&);
+template Vector8 load<Vector8>(const std::vector<Bitboard>&, std::size_t);
+template std::size_t evaluateLanes<Vector8>(const BatchEvaluator::Positions&,
+                                            std::size_t,
+                                            std::size_t,
+                                            BatchEvaluator::Evaluations&);
+#pragma GCC pop_options
+
+// SSE4.2 rather than plain SSE2 for the 32-bit lane multiply (pmulld).
+__attribute__((target("sse4.2"))) std::size_t evaluateSse42(const BatchEvaluator::Positions& in,
+                                                             std::size_t begin,
+                                                             std::size_t end,
+                                                             BatchEvaluator::Evaluations& out)
+{
+    return evaluateLanes<Vector4>(in, begin, end, out);
+}
+
+__attribute__((target("avx2"))) std::size_t evaluateAvx2(const BatchEvaluator::Positions& in,
+                                                          std::size_t begin,
+                                                          std::size_t end,
+                                                          BatchEvaluator::Evaluations& out)
+{
+    return evaluateLanes<Vector8>(in, begin, end, out);
+}
+#endif
+
+constexpr std::array<std::string_view, BatchEvaluator::FEATURES> FEATURE_NAMES = {
+    "men", "kings", "advancement", "backRank", "center", "mobility", "runaways",
+};
+}
+
+void BatchEvaluator::Positions::add(const Board& board)
+{
+    const PieceColor toMove = board.sideToMove();
+    const PieceColor other = toMove == PieceColor::First ? PieceColor::Second : PieceColor::First;
+    // The first player already advances towards row 0.
+    const bool turn = toMove == PieceColor::Second;
+    own.push_back(turn ? rotate(board.piecesOf(toMove)) : board.piecesOf(toMove));
+    enemy.push_back(turn ? rotate(board.piecesOf(other)) : board.piecesOf(other));
+    kings.push_back(turn ? rotate(board.kings()) : board.kings());
+}
+
+void BatchEvaluator::Positions::clear()
+{
+    own.clear();
+    enemy.clear();
+    kings.clear();
+}
+
+void BatchEvaluator::Positions::reserve(std::size_t count)
+{
+    own.reserve(count);
+    enemy.reserve(count);
+    kings.reserve(count);
+}
+
+std::size_t BatchEvaluator::Positions::size() const
+{
+    return own.size();
+}
+
+std::int32_t BatchEvaluator::Evaluations::feature(Feature which, std::size_t position) const
+{
+    return features[static_cast<std::size_t>(which)][position];
+}
+
+BatchEvaluator::BatchEvaluator()
+    : m_kernel(bestKernel())
+{
+}
+
+BatchEvaluator::BatchEvaluator(Kernel kernel)
+    : m_kernel(isSupported(kernel) ? kernel : bestKernel())
+{
+}
+
+BatchEvaluator::Kernel BatchEvaluator::kernel() const
+{
+    return m_kernel;
+}
+
+void BatchEvaluator::evaluate(const Positions& positions, Evaluations& out) const
+{
+    const std::size_t count = positions.size();
+    out.scores.resize(count);
+    for (auto& values : out.features)
+    {
+        values.resize(count);
+    }
+
+    std::size_t done = 0;
+#ifdef CHECKERS_BATCH_X86
+    if (m_kernel == Kernel::Avx2)
+    {
+        done = evaluateAvx2(positions, done, count, out);
+    }
+    else if (m_kernel == Kernel::Sse42)
+    {
+        done = evaluateSse42(positions, done, count, out);
+    }
+#endif
+    evaluateScalar(positions, done, count, out);
+}
+
+bool BatchEvaluator::isSupported(Kernel kernel)
+{
+    switch (kernel)
+    {
+    case Kernel::Scalar:
+        return true;
+#ifdef CHECKERS_BATCH_X86
+    case Kernel::Sse42:
+        return __builtin_cpu_supports("sse4.2");
+    case Kernel::Avx2:
+        return __builtin_cpu_supports("avx2");
+#else
+    case Kernel::Sse42:
+    case Kernel::Avx2:
+        return false;
+#endif
+    }
+    return false;
+}
+
+BatchEvaluator::Kernel BatchEvaluator::bestKernel()
+{
+    for (const Kernel kernel : {Kernel::Avx2, Kernel::Sse42})
+    {
+        if (isSupported(kernel))
+        {
+            return kernel;
+        }
+    }
+    return Kernel::Scalar;
+}
+
+std::string_view BatchEvaluator::name(Kernel kernel)
+{
+    switch (kernel)
+    {
+    case Kernel::Scalar:
+        return "scalar";
+    case Kernel::Sse42:
+        return "sse4.2";
+    case Kernel::Avx2:
+        return "avx2";
+    }
+    return "unknown";
+}
+
+std::string_view BatchEvaluator::name(Feature feature)
+{
+    return FEATURE_NAMES[static_cast<std::size_t>(feature)];
+}
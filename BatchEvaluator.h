@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "Board.h"
+
+// Computes the evaluation features of many positions at once, for the
+// `gamedb features` export. Positions are packed as three bitboards each, in
+// structure-of-arrays form, and every feature is computed for a whole vector
+// of positions at a time with shifts, masks and bit counts, so one
+// instruction works on 8 positions (AVX2) or 4 (SSE4.2). The widest kernel the
+// CPU supports is chosen at run time, with plain scalar code as the fallback;
+// all kernels give identical results, and the score equals Engine::evaluate.
+//
+// It is not a faster way to score positions: Engine::evaluate only adds up
+// terms Board keeps up to date move by move, while every feature here,
+// mobility and runaways included, is worked out from the bitboards.
+class BatchEvaluator
+{
+public:
+    // Each is the side to move's count minus the opponent's.
+    enum class Feature : std::uint8_t
+    {
+        Men,
+        Kings,
+        Advancement, // rows advanced by men, summed
+        BackRank,    // men still guarding their own back rank
+        Center,      // pieces on the four center squares
+        Mobility,    // non-capturing single steps to empty squares
+        Runaways,    // men with no piece anywhere on their way to promotion
+        Count
+    };
+
+    static constexpr std::size_t FEATURES = static_cast<std::size_t>(Feature::Count);
+
+    enum class Kernel : std::uint8_t
+    {
+        Scalar,
+        Sse42,
+        Avx2
+    };
+
+    // Compact snapshots of boards. They are turned so that the side to move
+    // always advances towards row 0, which leaves the kernels one orientation
+    // to handle; the board is symmetric under the half turn.
+    struct Positions
+    {
+        std::vector<Board::Bitboard> own; // pieces of the side to move
+        std::vector<Board::Bitboard> enemy;
+        std::vector<Board::Bitboard> kings;
+
+        void add(const Board& board);
+        void clear();
+        void reserve(std::size_t count);
+        std::size_t size() const;
+    };
+
+    // Indexed like the positions they were computed from.
+    struct Evaluations
+    {
+        std::vector<std::int32_t> scores;
+        std::array<std::vector<std::int32_t>, FEATURES> features;
+
+        std::int32_t feature(Feature which, std::size_t position) const;
+    };
+
+    // Uses the widest kernel the CPU supports.
+    BatchEvaluator();
+    // Falls back to the best supported kernel if `kernel` is not.
+    explicit BatchEvaluator(Kernel kernel);
+
+    Kernel kernel() const;
+    void evaluate(const Positions& positions, Evaluations& out) const;
+
+    static bool isSupported(Kernel kernel);
+    static Kernel bestKernel();
+    static std::string_view name(Kernel kernel);
+    static std::string_view name(Feature feature);
+
+private:
+    Kernel m_kernel;
+};
@@ -1,356 +1,1045 @@
 #include "Board.h"
 
+#include "Stats.h"
+#include "Zobrist.h"
+
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <span>
 
 namespace
 {
-constexpr float SELECTION_OUTLINE = 4.0f;
+template <int Size>
+constexpr int HALF = Size / 2;
+
+template <int Size>
+constexpr int SQUARES = Size * Size / 2;
+
+// Playable squares are stored HALF per row. Because dark squares are offset by
+// one column on alternate rows, a diagonal step is a shift of HALF on both row
+// parities plus HALF - 1 or HALF + 1 depending on parity, with the board edges
+// masked off before shifting.
+template <int Size>
+constexpr BitboardFor<Size> buildMask(bool evenRows, bool oddRows, int column)
+{
+    BitboardFor<Size> mask = 0;
+    for (int row = 0; row < Size; ++row)
+    {
+        const bool rowWanted = row % 2 == 0 ? evenRows : oddRows;
+        if (!rowWanted)
+        {
+            continue;
+        }
+        for (int k = 0; k < HALF<Size>; ++k)
+        {
+            if (column < 0 || column == k)
+            {
+                mask |= BitboardFor<Size>{1} << (row * HALF<Size> + k);
+            }
+        }
+    }
+    return mask;
 }
 
-Board::Board()
+template <int Size>
+constexpr BitboardFor<Size> ALL_SQUARES = buildMask<Size>(true, true, -1);
+template <int Size>
+constexpr BitboardFor<Size> EVEN_ROWS = buildMask<Size>(true, false, -1);
+template <int Size>
+constexpr BitboardFor<Size> ODD_ROWS = buildMask<Size>(false, true, -1);
+template <int Size>
+constexpr BitboardFor<Size> FIRST_COLUMN = buildMask<Size>(true, true, 0);
+template <int Size>
+constexpr BitboardFor<Size> LAST_COLUMN = buildMask<Size>(true, true, HALF<Size> - 1);
+template <int Size>
+constexpr BitboardFor<Size> TOP_ROW = (BitboardFor<Size>{1} << HALF<Size>) - 1;
+template <int Size>
+constexpr BitboardFor<Size> BOTTOM_ROW = TOP_ROW<Size> << (SQUARES<Size> - HALF<Size>);
+
+// Listed in the order moves have always been reported for kings.
+enum Direction
 {
-    reset();
+    DownRight,
+    DownLeft,
+    UpRight,
+    UpLeft
+};
+
+constexpr std::array<Direction, 4> ALL_DIRECTIONS{DownRight, DownLeft, UpRight, UpLeft};
+
+constexpr Direction opposite(Direction dir)
+{
+    switch (dir)
+    {
+    case DownRight:
+        return UpLeft;
+    case DownLeft:
+        return UpRight;
+    case UpRight:
+        return DownLeft;
+    case UpLeft:
+        return DownRight;
+    }
+    return dir;
 }
 
-void Board::reset()
+template <int Size>
+constexpr BitboardFor<Size> step(BitboardFor<Size> squares, Direction dir)
 {
-    for (auto& row : m_grid)
+    constexpr int half = HALF<Size>;
+    constexpr BitboardFor<Size> even = EVEN_ROWS<Size>;
+    constexpr BitboardFor<Size> odd = ODD_ROWS<Size>;
+    switch (dir)
     {
-        for (auto& cell : row)
-        {
-            cell.reset();
-        }
+    case DownRight:
+        return (((squares & even & ~LAST_COLUMN<Size>) << (half + 1)) | ((squares & odd) << half)) & ALL_SQUARES<Size>;
+    case DownLeft:
+        return (((squares & even) << half) | ((squares & odd & ~FIRST_COLUMN<Size>) << (half - 1))) & ALL_SQUARES<Size>;
+    case UpRight:
+        return ((squares & even & ~LAST_COLUMN<Size>) >> (half - 1)) | ((squares & odd) >> half);
+    case UpLeft:
+        return ((squares & even) >> half) | ((squares & odd & ~FIRST_COLUMN<Size>) >> (half + 1));
+    }
+    return 0;
+}
+
+template <int Size>
+constexpr BitboardFor<Size> promotionRow(PieceColor color)
+{
+    return color == PieceColor::First ? TOP_ROW<Size> : BOTTOM_ROW<Size>;
+}
+
+// Men of the first player advance towards row 0, men of the second towards the last row.
+constexpr bool isForward(PieceColor color, Direction dir)
+{
+    const bool up = dir == UpRight || dir == UpLeft;
+    return color == PieceColor::First ? up : !up;
+}
+
+constexpr std::array<Direction, 2> FIRST_MAN_DIRECTIONS{UpRight, UpLeft};
+constexpr std::array<Direction, 2> SECOND_MAN_DIRECTIONS{DownRight, DownLeft};
+
+// The directions a piece moves in, in ALL_DIRECTIONS order.
+std::span<const Direction> pieceDirections(PieceColor color, bool isKing)
+{
+    if (isKing)
+    {
+        return ALL_DIRECTIONS;
+    }
+    return color == PieceColor::First ? FIRST_MAN_DIRECTIONS : SECOND_MAN_DIRECTIONS;
+}
+
+constexpr Square directionStep(Direction dir)
+{
+    switch (dir)
+    {
+    case DownRight:
+        return {1, 1};
+    case DownLeft:
+        return {1, -1};
+    case UpRight:
+        return {-1, 1};
+    case UpLeft:
+        return {-1, -1};
     }
+    return {};
+}
 
-    for (int row = 0; row < SIZE; ++row)
+template <int Size>
+constexpr std::array<Square, SQUARES<Size>> buildPositions()
+{
+    std::array<Square, SQUARES<Size>> positions{};
+    for (int square = 0; square < SQUARES<Size>; ++square)
     {
-        for (int col = 0; col < SIZE; ++col)
+        const int row = square / HALF<Size>;
+        positions[square] = Square(row, (square % HALF<Size>) * 2 + (row % 2 == 0 ? 1 : 0));
+    }
+    return positions;
+}
+
+template <int Size>
+constexpr std::array<Square, SQUARES<Size>> POSITIONS = buildPositions<Size>();
+
+// The squares along one diagonal from a square, nearest first: the first is
+// the neighbour in that direction, the second where a jump over it lands, and
+// the whole list is a king's line of sight.
+template <int Size>
+struct Ray
+{
+    std::uint8_t length = 0;
+    std::array<std::uint8_t, Size - 1> squares{};
+};
+
+// Indexed by square, then Direction.
+template <int Size>
+using RayTable = std::array<std::array<Ray<Size>, ALL_DIRECTIONS.size()>, SQUARES<Size>>;
+
+template <int Size>
+constexpr RayTable<Size> buildRays()
+{
+    RayTable<Size> rays{};
+    for (int square = 0; square < SQUARES<Size>; ++square)
+    {
+        for (const Direction dir : ALL_DIRECTIONS)
         {
-            if (!isDarkSquare(row, col))
+            Ray<Size>& ray = rays[square][dir];
+            for (Square at = POSITIONS<Size>[square] + directionStep(dir);
+                 at.row >= 0 && at.row < Size && at.col >= 0 && at.col < Size;
+                 at += directionStep(dir))
             {
-                continue;
+                ray.squares[ray.length++] = static_cast<std::uint8_t>(at.row * HALF<Size> + at.col / 2);
             }
+        }
+    }
+    return rays;
+}
+
+template <int Size>
+constexpr RayTable<Size> RAYS = buildRays<Size>();
 
-            if (row < 3)
+// The rays are built from coordinates and step() from shifts; both must
+// describe the same board.
+template <int Size>
+constexpr bool raysMatchSteps()
+{
+    using Bitboard = BitboardFor<Size>;
+    for (int square = 0; square < SQUARES<Size>; ++square)
+    {
+        for (const Direction dir : ALL_DIRECTIONS)
+        {
+            const Ray<Size>& ray = RAYS<Size>[square][dir];
+            Bitboard current = step<Size>(Bitboard{1} << square, dir);
+            for (int i = 0; i < ray.length; ++i)
             {
-                m_grid[row][col].emplace(PieceColor::Second);
+                if (current != Bitboard{1} << ray.squares[i])
+                {
+                    return false;
+                }
+                current = step<Size>(current, dir);
             }
-            else if (row > 4)
+            if (current != 0)
             {
-                m_grid[row][col].emplace(PieceColor::First);
+                return false;
             }
         }
     }
+    return true;
 }
 
-void Board::draw(sf::RenderWindow& window,
-                 float cellSize,
-                 const std::optional<sf::Vector2i>& selected,
-                 const std::vector<sf::Vector2i>& highlightSquares) const
+static_assert(raysMatchSteps<8>());
+static_assert(raysMatchSteps<10>());
+
+template <typename Bitboard>
+constexpr bool contains(Bitboard squares, int square)
 {
-    const sf::Color lightSquare(245, 230, 200);
-    const sf::Color darkSquare(101, 67, 33);
+    return (squares >> square) & 1;
+}
 
-    sf::RectangleShape square(sf::Vector2f{cellSize, cellSize});
-    for (int row = 0; row < SIZE; ++row)
+// The middle squares of each of the two middle rows, leaving out the edges.
+template <int Size>
+constexpr BitboardFor<Size> centerSquares()
+{
+    BitboardFor<Size> mask = 0;
+    for (int row = Size / 2 - 1; row <= Size / 2; ++row)
     {
-        for (int col = 0; col < SIZE; ++col)
+        for (int k = 1; k < HALF<Size> - 1; ++k)
         {
-            square.setPosition({static_cast<float>(col) * cellSize,
-                                static_cast<float>(row) * cellSize});
-            square.setFillColor(isDarkSquare(row, col) ? darkSquare : lightSquare);
+            mask |= BitboardFor<Size>{1} << (row * HALF<Size> + k);
+        }
+    }
+    return mask;
+}
 
-            if (selected && selected->x == row && selected->y == col)
-            {
-                square.setOutlineColor(sf::Color(255, 215, 0, 200));
-                square.setOutlineThickness(SELECTION_OUTLINE);
-            }
-            else
+// What one piece adds to its side's evaluation terms, indexed like the
+// Zobrist keys: color (First, Second), then man/king, then square.
+template <typename BoardType>
+using PieceTermTable =
+    std::array<std::array<std::array<typename BoardType::EvalTerms, BoardType::SQUARES>, 2>, 2>;
+
+template <typename BoardType>
+constexpr PieceTermTable<BoardType> buildPieceTerms()
+{
+    constexpr int SIZE = BoardType::SIZE;
+    constexpr auto CENTER = centerSquares<SIZE>();
+    PieceTermTable<BoardType> table{};
+    for (int side = 0; side < 2; ++side)
+    {
+        for (int king = 0; king < 2; ++king)
+        {
+            for (int square = 0; square < BoardType::SQUARES; ++square)
             {
-                square.setOutlineThickness(0.f);
+                const int row = square / HALF<SIZE>;
+                const int advanced = side == 0 ? SIZE - 1 - row : row;
+                typename BoardType::EvalTerms& terms = table[side][king][square];
+                terms.men = king ? 0 : 1;
+                terms.kings = king ? 1 : 0;
+                terms.tempo = static_cast<std::uint8_t>(king ? 0 : advanced);
+                terms.backRank = !king && advanced == 0 ? 1 : 0;
+                terms.center = (CENTER >> square) & 1;
             }
-
-            window.draw(square);
         }
     }
+    return table;
+}
+
+template <typename BoardType>
+constexpr PieceTermTable<BoardType> PIECE_TERMS = buildPieceTerms<BoardType>();
+
+template <typename BoardType>
+const typename BoardType::EvalTerms& pieceTerms(PieceColor color, bool king, int square)
+{
+    return PIECE_TERMS<BoardType>[color == PieceColor::First ? 0 : 1][king ? 1 : 0][square];
+}
+
+template <typename EvalTerms>
+void addTerms(EvalTerms& totals, const EvalTerms& piece)
+{
+    totals.men += piece.men;
+    totals.kings += piece.kings;
+    totals.tempo += piece.tempo;
+    totals.backRank += piece.backRank;
+    totals.center += piece.center;
+}
+
+template <typename EvalTerms>
+void removeTerms(EvalTerms& totals, const EvalTerms& piece)
+{
+    totals.men -= piece.men;
+    totals.kings -= piece.kings;
+    totals.tempo -= piece.tempo;
+    totals.backRank -= piece.backRank;
+    totals.center -= piece.center;
+}
 
-    sf::CircleShape highlight(cellSize * 0.2f);
-    highlight.setFillColor(sf::Color(255, 215, 0, 120));
-    for (const auto& sq : highlightSquares)
+template <typename Bitboard, typename Move>
+Bitboard capturedSquares(const Move& move)
+{
+    Bitboard captured = 0;
+    for (int hop = 0; hop < move.hopCount; ++hop)
     {
-        highlight.setPosition({(static_cast<float>(sq.y) + 0.5f) * cellSize - highlight.getRadius(),
-                               (static_cast<float>(sq.x) + 0.5f) * cellSize - highlight.getRadius()});
-        window.draw(highlight);
+        captured |= Bitboard{1} << move.jumped[hop];
     }
+    return captured;
+}
 
-    for (int row = 0; row < SIZE; ++row)
+// Drops the captures from `first` on that end where an earlier one does
+// having taken the same pieces.
+template <typename Bitboard, typename MoveList>
+void mergeEqualCaptures(MoveList& moves, std::size_t first)
+{
+    std::size_t kept = first;
+    for (std::size_t i = first; i < moves.size(); ++i)
     {
-        for (int col = 0; col < SIZE; ++col)
+        const Bitboard captured = capturedSquares<Bitboard>(moves[i]);
+        bool repeated = false;
+        for (std::size_t k = first; k < kept && !repeated; ++k)
         {
-            const auto& cell = m_grid[row][col];
-            if (!cell)
-            {
-                continue;
-            }
+            repeated = moves[k].to == moves[i].to && capturedSquares<Bitboard>(moves[k]) == captured;
+        }
+        if (!repeated)
+        {
+            moves[kept++] = moves[i];
+        }
+    }
+    moves.truncate(kept);
+}
 
-            sf::CircleShape pieceShape(cellSize * 0.38f);
-            const sf::Color fill = cell->getColor() == PieceColor::First ? sf::Color(220, 200, 170)
-                                                                          : sf::Color(120, 70, 50);
-            pieceShape.setFillColor(fill);
-            pieceShape.setOutlineColor(sf::Color(60, 40, 25));
-            pieceShape.setOutlineThickness(cell->isKing() ? 4.f : 2.5f);
-            pieceShape.setPosition({(static_cast<float>(col) + 0.5f) * cellSize - pieceShape.getRadius(),
-                                    (static_cast<float>(row) + 0.5f) * cellSize - pieceShape.getRadius()});
-            window.draw(pieceShape);
-
-            if (cell->isKing())
-            {
-                sf::CircleShape inner(pieceShape.getRadius() * 0.5f);
-                inner.setFillColor(cell->getColor() == PieceColor::First ? sf::Color(240, 220, 190) : sf::Color(140, 90, 70));
-                inner.setOutlineColor(sf::Color(80, 50, 30));
-                inner.setOutlineThickness(1.5f);
-                inner.setPosition({pieceShape.getPosition().x + pieceShape.getRadius() - inner.getRadius(),
-                                   pieceShape.getPosition().y + pieceShape.getRadius() - inner.getRadius()});
-                window.draw(inner);
-            }
+// Moves from `first` on all continue one jump; the ones that stop right
+// after it are dropped if any of the others goes on capturing.
+template <typename MoveList>
+void dropEarlyStops(MoveList& moves, std::size_t first, int hops)
+{
+    const bool continues = std::any_of(moves.begin() + first, moves.end(),
+                                       [hops](const auto& move) { return move.hopCount > hops; });
+    if (!continues)
+    {
+        return;
+    }
+    std::size_t kept = first;
+    for (std::size_t i = first; i < moves.size(); ++i)
+    {
+        if (moves[i].hopCount > hops)
+        {
+            moves[kept++] = moves[i];
         }
     }
+    moves.truncate(kept);
 }
 
-const Piece* Board::pieceAt(sf::Vector2i position) const
+// Counts one generator call and the moves it produced.
+template <typename MoveList>
+void countGenerated(Stats::Counter call, const MoveList& moves)
 {
-    if (!isInside(position))
+    std::size_t captures = 0;
+    for (const auto& move : moves)
     {
-        return nullptr;
+        captures += move.isCapture ? 1 : 0;
     }
-    const auto& entry = m_grid[position.x][position.y];
-    return entry ? &(*entry) : nullptr;
+    Stats::add(call);
+    Stats::add(Stats::Counter::MovesGenerated, moves.size());
+    Stats::add(Stats::Counter::CapturesGenerated, captures);
+}
+}
+
+template <int Size, typename Rules>
+bool BasicBoard<Size, Rules>::Move::operator==(const Move& other) const
+{
+    return from == other.from && to == other.to && hopCount == other.hopCount
+        && std::equal(landings.begin(), landings.begin() + hopCount, other.landings.begin());
 }
 
-bool Board::isInside(sf::Vector2i position)
+template <int Size, typename Rules>
+BasicBoard<Size, Rules>::BasicBoard()
 {
-    return position.x >= 0 && position.x < SIZE && position.y >= 0 && position.y < SIZE;
+    reset();
 }
 
-std::vector<Board::Move> Board::getMovesForPiece(sf::Vector2i from, bool capturesOnly) const
+template <int Size, typename Rules>
+void BasicBoard<Size, Rules>::reset()
 {
-    std::vector<Move> moves;
-    if (!isInside(from))
+    m_first = 0;
+    m_second = 0;
+    m_kings = 0;
+    m_sideToMove = PieceColor::First;
+
+    for (int square = 0; square < SQUARES; ++square)
     {
-        return moves;
+        const int row = square / HALF<Size>;
+        if (row < SIZE / 2 - 1)
+        {
+            m_second |= Bitboard{1} << square;
+        }
+        else if (row > SIZE / 2)
+        {
+            m_first |= Bitboard{1} << square;
+        }
     }
+    m_hash = computeHash();
+    m_terms = {computeEvalTerms(PieceColor::First), computeEvalTerms(PieceColor::Second)};
+    invalidateSummaries();
+}
+
+template <int Size, typename Rules>
+void BasicBoard<Size, Rules>::setPosition(Bitboard first, Bitboard second, Bitboard kings, PieceColor sideToMove)
+{
+    m_first = first & ALL_SQUARES<Size>;
+    m_second = second & ALL_SQUARES<Size> & ~m_first;
+    m_kings = kings & (m_first | m_second);
+    m_sideToMove = sideToMove;
+    m_hash = computeHash();
+    m_terms = {computeEvalTerms(PieceColor::First), computeEvalTerms(PieceColor::Second)};
+    invalidateSummaries();
+}
 
-    const auto& pieceSlot = m_grid[from.x][from.y];
-    if (!pieceSlot)
+template <int Size, typename Rules>
+std::optional<Piece> BasicBoard<Size, Rules>::pieceAt(Square position) const
+{
+    const int square = squareIndex(position);
+    if (square < 0)
     {
-        return moves;
+        return std::nullopt;
     }
 
-    std::vector<Move> capturingMoves;
-    const auto directions = moveDirectionsForPiece(*pieceSlot);
-
-    for (const auto& dir : directions)
+    const Bitboard bit = Bitboard{1} << square;
+    if (!((m_first | m_second) & bit))
     {
-        sf::Vector2i current = from + dir;
-        bool foundEnemy = false;
-        sf::Vector2i enemyPos{-1, -1};
+        return std::nullopt;
+    }
+    return Piece((m_first & bit) ? PieceColor::First : PieceColor::Second, (m_kings & bit) != 0);
+}
 
-        while (isInside(current))
-        {
-            const auto& cell = m_grid[current.x][current.y];
+template <int Size, typename Rules>
+bool BasicBoard<Size, Rules>::isInside(Square position)
+{
+    return position.row >= 0 && position.row < SIZE && position.col >= 0 && position.col < SIZE;
+}
 
-            if (!cell)
-            {
-                if (!capturesOnly && !foundEnemy)
-                {
-                    Move move;
-                    move.from = from;
-                    move.to = current;
-                    moves.push_back(move);
-                }
-                else if (foundEnemy)
-                {
-                    Move capture;
-                    capture.from = from;
-                    capture.to = current;
-                    capture.isCapture = true;
-                    capture.captured = enemyPos;
-                    capturingMoves.push_back(capture);
-                }
+template <int Size, typename Rules>
+std::vector<typename BasicBoard<Size, Rules>::Move> BasicBoard<Size, Rules>::getMovesForPiece(Square from,
+                                                                                            bool capturesOnly) const
+{
+    MoveList moves;
+    getMovesForPiece(from, capturesOnly, moves);
+    return {moves.begin(), moves.end()};
+}
 
-                if (!pieceSlot->isKing())
-                {
-                    break;
-                }
-                current += dir;
-                continue;
-            }
+template <int Size, typename Rules>
+void BasicBoard<Size, Rules>::getMovesForPiece(Square from, bool capturesOnly, MoveList& moves) const
+{
+    moves.clear();
+    const int square = squareIndex(from);
+    if (square >= 0)
+    {
+        appendPieceMoves(square, capturesOnly, moves);
+    }
+    countGenerated(Stats::Counter::PieceMoveCalls, moves);
+}
 
-            if (cell->getColor() == pieceSlot->getColor())
-            {
-                break;
-            }
+template <int Size, typename Rules>
+std::vector<typename BasicBoard<Size, Rules>::Move> BasicBoard<Size, Rules>::getAllMoves(PieceColor color,
+                                                                                       bool capturesOnly) const
+{
+    MoveList moves;
+    getAllMoves(color, capturesOnly, moves);
+    return {moves.begin(), moves.end()};
+}
 
-            if (foundEnemy)
-            {
-                break;
-            }
-            foundEnemy = true;
-            enemyPos = current;
-            current += dir;
+template <int Size, typename Rules>
+void BasicBoard<Size, Rules>::getAllMoves(PieceColor color, bool capturesOnly, MoveList& moves) const
+{
+    moves.clear();
+    const Bitboard movers = capturesOnly ? summary(color).captureSources : piecesOf(color);
+    for (Bitboard pieces = movers; pieces != 0; pieces &= pieces - 1)
+    {
+        appendPieceMoves(std::countr_zero(pieces), capturesOnly, moves);
+    }
+    countGenerated(Stats::Counter::GenerateCalls, moves);
+}
 
-            if (!pieceSlot->isKing())
-            {
-                if (isInside(current) && !m_grid[current.x][current.y])
-                {
-                    Move capture;
-                    capture.from = from;
-                    capture.to = current;
-                    capture.isCapture = true;
-                    capture.captured = enemyPos;
-                    capturingMoves.push_back(capture);
-                }
-                break;
-            }
+template <int Size, typename Rules>
+void BasicBoard<Size, Rules>::getLegalMoves(PieceColor color, MoveList& moves) const
+{
+    moves.clear();
+    const Bitboard sources = summary(color).captureSources;
+    if (sources == 0)
+    {
+        for (Bitboard pieces = piecesOf(color); pieces != 0; pieces &= pieces - 1)
+        {
+            appendPieceMoves(std::countr_zero(pieces), false, moves);
         }
+        // Without a capture on the board every move is quiet.
+        Stats::add(Stats::Counter::GenerateCalls);
+        Stats::add(Stats::Counter::MovesGenerated, moves.size());
+        return;
     }
 
-    if (!capturingMoves.empty())
+    const Bitboard enemy = color == PieceColor::First ? m_second : m_first;
+    for (Bitboard pieces = sources; pieces != 0; pieces &= pieces - 1)
     {
-        return capturingMoves;
-    }
+        const int square = std::countr_zero(pieces);
+        const Bitboard bit = Bitboard{1} << square;
 
-    return moves;
-}
+        Move move;
+        move.from = squarePosition(square);
+        move.isCapture = true;
+        const std::size_t firstNew = moves.size();
+        // The moving piece no longer occupies its starting square once it jumps.
+        appendCaptureSequences(square, (m_kings & bit) != 0, color, enemy, emptySquares() | bit, move, moves);
+        if constexpr (Rules::MERGE_EQUAL_CAPTURES)
+        {
+            mergeEqualCaptures<Bitboard>(moves, firstNew);
+        }
+    }
 
-std::vector<Board::Move> Board::getAllMoves(PieceColor color, bool capturesOnly) const
-{
-    std::vector<Move> result;
-    for (int row = 0; row < SIZE; ++row)
+    if constexpr (Rules::MAXIMUM_CAPTURE)
     {
-        for (int col = 0; col < SIZE; ++col)
+        std::uint8_t longest = 0;
+        for (const Move& move : moves)
+        {
+            longest = std::max(longest, move.hopCount);
+        }
+        std::size_t kept = 0;
+        for (const Move& move : moves)
         {
-            const auto& cell = m_grid[row][col];
-            if (!cell || cell->getColor() != color)
+            if (move.hopCount == longest)
             {
-                continue;
+                moves[kept++] = move;
             }
-
-            auto moves = getMovesForPiece({row, col}, capturesOnly);
-            result.insert(result.end(), moves.begin(), moves.end());
         }
+        moves.truncate(kept);
     }
-    return result;
+    Stats::add(Stats::Counter::GenerateCalls);
+    Stats::add(Stats::Counter::MovesGenerated, moves.size());
+    Stats::add(Stats::Counter::CapturesGenerated, moves.size());
 }
 
-bool Board::applyMove(const Move& move)
+template <int Size, typename Rules>
+bool BasicBoard<Size, Rules>::applyMove(const Move& move)
 {
-    if (!isInside(move.from) || !isInside(move.to))
+    Stats::add(Stats::Counter::ApplyMoveCalls);
+    const int fromSquare = squareIndex(move.from);
+    const int toSquare = squareIndex(move.to);
+    if (fromSquare < 0 || toSquare < 0 || move.hopCount > MAX_HOPS)
     {
         return false;
     }
 
-    auto& fromCell = m_grid[move.from.x][move.from.y];
-    if (!fromCell || m_grid[move.to.x][move.to.y])
+    const Bitboard fromBit = Bitboard{1} << fromSquare;
+    const Bitboard toBit = Bitboard{1} << toSquare;
+    const Bitboard occupied = m_first | m_second;
+    if (!(occupied & fromBit))
     {
         return false;
     }
 
-    m_grid[move.to.x][move.to.y] = fromCell;
-    fromCell.reset();
-
-    if (move.isCapture && isInside(move.captured))
+    const Bitboard enemy = (m_first & fromBit) ? m_second : m_first;
+    const Bitboard captured = capturedSquares<Bitboard>(move);
+    // A king's capture sequence may end where it started or on a square it
+    // emptied earlier in the same sequence.
+    if ((captured & ~enemy) || (occupied & toBit & ~(fromBit | captured)))
     {
-        m_grid[move.captured.x][move.captured.y].reset();
+        return false;
     }
 
-    promoteIfNeeded(move.to);
+    makeMove(move);
     return true;
 }
 
-bool Board::hasCaptureMoves(PieceColor color) const
+template <int Size, typename Rules>
+typename BasicBoard<Size, Rules>::Undo BasicBoard<Size, Rules>::makeMove(const Move& move)
 {
-    for (int row = 0; row < SIZE; ++row)
+    Stats::add(Stats::Counter::MakeMoveCalls);
+    const int fromSquare = squareIndex(move.from);
+    const int toSquare = squareIndex(move.to);
+    const Bitboard fromBit = Bitboard{1} << fromSquare;
+    const Bitboard toBit = Bitboard{1} << toSquare;
+
+    const PieceColor color = (m_first & fromBit) ? PieceColor::First : PieceColor::Second;
+    const PieceColor enemyColor = color == PieceColor::First ? PieceColor::Second : PieceColor::First;
+    Bitboard& own = color == PieceColor::First ? m_first : m_second;
+    Bitboard& enemy = color == PieceColor::First ? m_second : m_first;
+
+    Undo undo;
+    undo.from = static_cast<std::uint8_t>(fromSquare);
+    undo.to = static_cast<std::uint8_t>(toSquare);
+    undo.hash = m_hash;
+    undo.terms = m_terms;
+    undo.summariesValid = m_summariesValid;
+    for (int side = 0; side < 2; ++side)
     {
-        for (int col = 0; col < SIZE; ++col)
-        {
-            const auto& cell = m_grid[row][col];
-            if (!cell || cell->getColor() != color)
-            {
-                continue;
-            }
+        undo.captureSources[side] = m_summaries[side].captureSources;
+        undo.hasMoves[side] = m_summaries[side].hasMoves;
+    }
 
-            auto moves = getMovesForPiece({row, col}, true);
-            if (!moves.empty())
-            {
-                return true;
-            }
-        }
+    const bool wasKing = (m_kings & fromBit) != 0;
+    m_hash ^= Zobrist::pieceKey<SQUARES>(color, wasKing, fromSquare) ^ Zobrist::pieceKey<SQUARES>(color, wasKing, toSquare);
+    EvalTerms& ownTerms = m_terms[color == PieceColor::First ? 0 : 1];
+    EvalTerms& enemyTerms = m_terms[color == PieceColor::First ? 1 : 0];
+    removeTerms(ownTerms, pieceTerms<BasicBoard>(color, wasKing, fromSquare));
+    addTerms(ownTerms, pieceTerms<BasicBoard>(color, wasKing, toSquare));
+    for (int hop = 0; hop < move.hopCount; ++hop)
+    {
+        const int square = move.jumped[hop];
+        const bool jumpedKing = (m_kings >> square) & 1;
+        undo.captured |= Bitboard{1} << square;
+        m_hash ^= Zobrist::pieceKey<SQUARES>(enemyColor, jumpedKing, square);
+        removeTerms(enemyTerms, pieceTerms<BasicBoard>(enemyColor, jumpedKing, square));
+    }
+    undo.capturedKings = m_kings & undo.captured;
+
+    own = (own & ~fromBit) | toBit;
+    enemy &= ~undo.captured;
+    m_kings &= ~(fromBit | undo.captured);
+    if (wasKing)
+    {
+        m_kings |= toBit;
+    }
+    else if (move.promotes || (toBit & promotionRow<Size>(color)))
+    {
+        crown(toSquare);
+        undo.promoted = true;
+    }
+
+    switchSideToMove();
+    invalidateSummaries();
+    return undo;
+}
+
+template <int Size, typename Rules>
+void BasicBoard<Size, Rules>::unmakeMove(const Undo& undo)
+{
+    const Bitboard fromBit = Bitboard{1} << undo.from;
+    const Bitboard toBit = Bitboard{1} << undo.to;
+    const bool firstMoved = (m_first & toBit) != 0;
+    Bitboard& own = firstMoved ? m_first : m_second;
+    Bitboard& enemy = firstMoved ? m_second : m_first;
+    const bool wasKing = (m_kings & toBit) && !undo.promoted;
+
+    own = (own & ~toBit) | fromBit;
+    enemy |= undo.captured;
+    m_kings = (m_kings & ~toBit) | undo.capturedKings;
+    if (wasKing)
+    {
+        m_kings |= fromBit;
+    }
+
+    m_sideToMove = firstMoved ? PieceColor::First : PieceColor::Second;
+    m_hash = undo.hash;
+    m_terms = undo.terms;
+    m_summariesValid = undo.summariesValid;
+    for (int side = 0; side < 2; ++side)
+    {
+        m_summaries[side].captureSources = undo.captureSources[side];
+        m_summaries[side].hasMoves = undo.hasMoves[side];
     }
-    return false;
 }
 
-bool Board::playerHasMoves(PieceColor color) const
+template <int Size, typename Rules>
+bool BasicBoard<Size, Rules>::hasCaptureMoves(PieceColor color) const
 {
-    const bool mustCapture = hasCaptureMoves(color);
-    auto moves = getAllMoves(color, mustCapture);
-    return !moves.empty();
+    return summary(color).captureSources != 0;
 }
 
-int Board::countPieces(PieceColor color) const
+template <int Size, typename Rules>
+bool BasicBoard<Size, Rules>::playerHasMoves(PieceColor color) const
 {
-    int total = 0;
-    for (const auto& row : m_grid)
+    return summary(color).hasMoves;
+}
+
+template <int Size, typename Rules>
+const typename BasicBoard<Size, Rules>::SideSummary& BasicBoard<Size, Rules>::summary(PieceColor color) const
+{
+    const int index = color == PieceColor::First ? 0 : 1;
+    SideSummary& entry = m_summaries[index];
+    const std::uint8_t bit = std::uint8_t{1} << index;
+    if (m_summariesValid & bit)
     {
-        for (const auto& cell : row)
+        return entry;
+    }
+
+    entry.captureSources = captureSources(color);
+    entry.hasMoves = entry.captureSources != 0;
+    const Bitboard own = piecesOf(color);
+    const Bitboard empty = emptySquares();
+    for (Direction dir : ALL_DIRECTIONS)
+    {
+        if (entry.hasMoves)
         {
-            if (cell && cell->getColor() == color)
-            {
-                ++total;
-            }
+            break;
         }
+        const Bitboard movers = isForward(color, dir) ? own : (own & m_kings);
+        entry.hasMoves = (step<Size>(movers, dir) & empty) != 0;
     }
-    return total;
+    m_summariesValid |= bit;
+    return entry;
+}
+
+template <int Size, typename Rules>
+void BasicBoard<Size, Rules>::invalidateSummaries()
+{
+    m_summariesValid = 0;
+}
+
+template <int Size, typename Rules>
+int BasicBoard<Size, Rules>::countPieces(PieceColor color) const
+{
+    return std::popcount(piecesOf(color));
 }
 
-bool Board::isDarkSquare(int row, int col)
+template <int Size, typename Rules>
+bool BasicBoard<Size, Rules>::isDarkSquare(int row, int col)
 {
     return (row + col) % 2 == 1;
 }
 
-std::vector<sf::Vector2i> Board::moveDirectionsForPiece(const Piece& piece) const
+template <int Size, typename Rules>
+int BasicBoard<Size, Rules>::squareIndex(Square position)
+{
+    if (!isInside(position) || !isDarkSquare(position.row, position.col))
+    {
+        return -1;
+    }
+    return position.row * HALF<Size> + position.col / 2;
+}
+
+template <int Size, typename Rules>
+Square BasicBoard<Size, Rules>::squarePosition(int square)
+{
+    return POSITIONS<Size>[square];
+}
+
+template <int Size, typename Rules>
+typename BasicBoard<Size, Rules>::Bitboard BasicBoard<Size, Rules>::piecesOf(PieceColor color) const
+{
+    return color == PieceColor::First ? m_first : m_second;
+}
+
+template <int Size, typename Rules>
+PieceColor BasicBoard<Size, Rules>::sideToMove() const
+{
+    return m_sideToMove;
+}
+
+template <int Size, typename Rules>
+void BasicBoard<Size, Rules>::setSideToMove(PieceColor color)
+{
+    if (color != m_sideToMove)
+    {
+        switchSideToMove();
+    }
+}
+
+template <int Size, typename Rules>
+std::uint64_t BasicBoard<Size, Rules>::hash() const
+{
+    return m_hash;
+}
+
+template <int Size, typename Rules>
+std::uint64_t BasicBoard<Size, Rules>::computeHash() const
+{
+    std::uint64_t hash = m_sideToMove == PieceColor::Second ? Zobrist::KEYS<SQUARES>.secondToMove : 0;
+    for (Bitboard pieces = m_first | m_second; pieces != 0; pieces &= pieces - 1)
+    {
+        const int square = std::countr_zero(pieces);
+        const PieceColor color = ((m_first >> square) & 1) ? PieceColor::First : PieceColor::Second;
+        hash ^= Zobrist::pieceKey<SQUARES>(color, (m_kings >> square) & 1, square);
+    }
+    return hash;
+}
+
+template <int Size, typename Rules>
+const typename BasicBoard<Size, Rules>::EvalTerms& BasicBoard<Size, Rules>::evalTerms(PieceColor color) const
+{
+    return m_terms[color == PieceColor::First ? 0 : 1];
+}
+
+template <int Size, typename Rules>
+typename BasicBoard<Size, Rules>::EvalTerms BasicBoard<Size, Rules>::computeEvalTerms(PieceColor color) const
 {
-    std::vector<sf::Vector2i> directions;
-    const int forward = piece.getColor() == PieceColor::First ? -1 : 1;
-    if (piece.isKing())
+    EvalTerms terms;
+    for (Bitboard pieces = piecesOf(color); pieces != 0; pieces &= pieces - 1)
     {
-        directions.push_back({1, 1});
-        directions.push_back({1, -1});
-        directions.push_back({-1, 1});
-        directions.push_back({-1, -1});
+        const int square = std::countr_zero(pieces);
+        addTerms(terms, pieceTerms<BasicBoard>(color, (m_kings >> square) & 1, square));
     }
-    else
+    return terms;
+}
+
+template <int Size, typename Rules>
+typename BasicBoard<Size, Rules>::Bitboard BasicBoard<Size, Rules>::kings() const
+{
+    return m_kings;
+}
+
+template <int Size, typename Rules>
+typename BasicBoard<Size, Rules>::Bitboard BasicBoard<Size, Rules>::emptySquares() const
+{
+    return ~(m_first | m_second) & ALL_SQUARES<Size>;
+}
+
+template <int Size, typename Rules>
+typename BasicBoard<Size, Rules>::Bitboard BasicBoard<Size, Rules>::captureSources(PieceColor color) const
+{
+    const Bitboard own = piecesOf(color);
+    const Bitboard enemy = color == PieceColor::First ? m_second : m_first;
+    const Bitboard empty = emptySquares();
+    const Bitboard men = own & ~m_kings;
+    const Bitboard kings = own & m_kings;
+
+    Bitboard sources = 0;
+    for (Direction dir : ALL_DIRECTIONS)
     {
-        directions.push_back({forward, -1});
-        directions.push_back({forward, 1});
+        const Direction back = opposite(dir);
+        // Enemy pieces with an empty landing square behind them, then walk
+        // backwards over empty squares looking for a piece that can reach them.
+        Bitboard reach = step<Size>(step<Size>(empty, back) & enemy, back);
+        if (Rules::MEN_CAPTURE_BACKWARDS || isForward(color, dir))
+        {
+            sources |= reach & men;
+        }
+        if constexpr (Rules::FLYING_KINGS)
+        {
+            while (reach)
+            {
+                sources |= reach & kings;
+                reach = step<Size>(reach & empty, back);
+            }
+        }
+        else
+        {
+            sources |= reach & kings;
+        }
     }
-    return directions;
+    return sources;
 }
 
-void Board::promoteIfNeeded(sf::Vector2i position)
+template <int Size, typename Rules>
+void BasicBoard<Size, Rules>::appendPieceMoves(int square, bool capturesOnly, MoveList& moves) const
 {
-    auto& cell = m_grid[position.x][position.y];
-    if (!cell)
+    const Bitboard bit = Bitboard{1} << square;
+    if (!((m_first | m_second) & bit))
     {
         return;
     }
 
-    if (cell->getColor() == PieceColor::First && position.x == 0)
+    const PieceColor color = (m_first & bit) ? PieceColor::First : PieceColor::Second;
+    const Bitboard enemy = color == PieceColor::First ? m_second : m_first;
+    const Bitboard empty = emptySquares();
+    const bool isKing = (m_kings & bit) != 0;
+    const bool slides = Rules::FLYING_KINGS && isKing;
+    const Square from = POSITIONS<Size>[square];
+
+    const std::size_t firstNew = moves.size();
+    bool foundCapture = false;
+    const Bitboard promotion = isKing ? 0 : promotionRow<Size>(color);
+
+    for (const Direction dir : pieceDirections(color, isKing || Rules::MEN_CAPTURE_BACKWARDS))
     {
-        cell->promoteToKing();
+        const Ray<Size>& ray = RAYS<Size>[square][dir];
+        // Men that capture backwards still only move forwards.
+        const bool movesThisWay = isKing || isForward(color, dir);
+        int i = 0;
+        for (; i < ray.length && contains(empty, ray.squares[i]); ++i)
+        {
+            if (movesThisWay && !capturesOnly && !foundCapture)
+            {
+                Move move;
+                move.from = from;
+                move.to = POSITIONS<Size>[ray.squares[i]];
+                move.promotes = contains(promotion, ray.squares[i]);
+                moves.push_back(move);
+            }
+            if (!slides)
+            {
+                break;
+            }
+        }
+
+        if (i == ray.length || !contains(enemy, ray.squares[i]))
+        {
+            continue;
+        }
+
+        const std::uint8_t enemySquare = ray.squares[i];
+        for (int j = i + 1; j < ray.length && contains(empty, ray.squares[j]); ++j)
+        {
+            if (!foundCapture)
+            {
+                // Once a capture exists the piece may only capture, so drop the quiet moves.
+                moves.truncate(firstNew);
+                foundCapture = true;
+            }
+
+            Move capture;
+            capture.from = from;
+            capture.to = POSITIONS<Size>[ray.squares[j]];
+            capture.isCapture = true;
+            capture.promotes = contains(promotion, ray.squares[j]);
+            capture.hopCount = 1;
+            capture.landings[0] = ray.squares[j];
+            capture.jumped[0] = enemySquare;
+            moves.push_back(capture);
+
+            if (!slides)
+            {
+                break;
+            }
+        }
     }
-    else if (cell->getColor() == PieceColor::Second && position.x == SIZE - 1)
+}
+
+template <int Size, typename Rules>
+void BasicBoard<Size, Rules>::appendCaptureSequences(int square,
+                                                     bool isKing,
+                                                     PieceColor color,
+                                                     Bitboard enemy,
+                                                     Bitboard empty,
+                                                     Move& move,
+                                                     MoveList& moves) const
+{
+    bool extended = false;
+    const bool slides = Rules::FLYING_KINGS && isKing;
+    const Bitboard promotion = isKing ? 0 : promotionRow<Size>(color);
+
+    for (const Direction dir : pieceDirections(color, isKing || Rules::MEN_CAPTURE_BACKWARDS))
     {
-        cell->promoteToKing();
+        const Ray<Size>& ray = RAYS<Size>[square][dir];
+        int i = 0;
+        while (slides && i < ray.length && contains(empty, ray.squares[i]))
+        {
+            ++i;
+        }
+        if (i == ray.length || !contains(enemy, ray.squares[i]))
+        {
+            continue;
+        }
+
+        // Jumped pieces can never be jumped again. Under house rules they are
+        // removed as soon as they are captured, so later hops may pass over
+        // their squares; otherwise they block the rest of the sequence.
+        const std::uint8_t jumpedSquare = ray.squares[i];
+        const Bitboard jumpedBit = Bitboard{1} << jumpedSquare;
+        const Bitboard emptyAfter = Rules::REMOVE_WHEN_JUMPED ? empty | jumpedBit : empty;
+        const std::size_t firstLanding = moves.size();
+        for (int j = i + 1; j < ray.length && contains(empty, ray.squares[j]); ++j)
+        {
+            extended = true;
+
+            const bool crowned = Rules::CROWNING != CrowningInCapture::OnlyAtEnd && contains(promotion, ray.squares[j]);
+            const bool promotedBefore = move.promotes;
+            move.landings[move.hopCount] = ray.squares[j];
+            move.jumped[move.hopCount] = jumpedSquare;
+            ++move.hopCount;
+            move.promotes = promotedBefore || crowned;
+
+            if (crowned && Rules::CROWNING == CrowningInCapture::EndsMove)
+            {
+                Move complete = move;
+                complete.to = POSITIONS<Size>[ray.squares[j]];
+                moves.push_back(complete);
+            }
+            else
+            {
+                appendCaptureSequences(ray.squares[j],
+                                       isKing || crowned,
+                                       color,
+                                       enemy & ~jumpedBit,
+                                       emptyAfter,
+                                       move,
+                                       moves);
+            }
+
+            --move.hopCount;
+            move.promotes = promotedBefore;
+
+            if (!slides)
+            {
+                break;
+            }
+        }
+
+        if constexpr (Rules::KINGS_LAND_TO_CONTINUE)
+        {
+            if (slides)
+            {
+                dropEarlyStops(moves, firstLanding, move.hopCount + 1);
+            }
+        }
     }
+
+    if (!extended && move.hopCount > 0)
+    {
+        const std::uint8_t last = move.landings[move.hopCount - 1];
+        Move complete = move;
+        complete.to = POSITIONS<Size>[last];
+        // A man that only passed over the far row is crowned if it ends there.
+        complete.promotes = move.promotes || contains(promotion, last);
+        moves.push_back(complete);
+    }
+}
+
+template <int Size, typename Rules>
+void BasicBoard<Size, Rules>::crown(int square)
+{
+    const Bitboard bit = Bitboard{1} << square;
+    const PieceColor color = (m_first & bit) ? PieceColor::First : PieceColor::Second;
+    m_hash ^= Zobrist::pieceKey<SQUARES>(color, false, square) ^ Zobrist::pieceKey<SQUARES>(color, true, square);
+    EvalTerms& terms = m_terms[color == PieceColor::First ? 0 : 1];
+    removeTerms(terms, pieceTerms<BasicBoard>(color, false, square));
+    addTerms(terms, pieceTerms<BasicBoard>(color, true, square));
+    m_kings |= bit;
 }
+
+template <int Size, typename Rules>
+void BasicBoard<Size, Rules>::switchSideToMove()
+{
+    m_sideToMove = m_sideToMove == PieceColor::First ? PieceColor::Second : PieceColor::First;
+    m_hash ^= Zobrist::KEYS<SQUARES>.secondToMove;
+}
+
+template class BasicBoard<8, HouseRules>;
+template class BasicBoard<8, EnglishRules>;
+template class BasicBoard<8, RussianRules>;
+template class BasicBoard<10, InternationalRules>;
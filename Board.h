@@ -1,47 +1,173 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include <optional>
+#include <type_traits>
 #include <vector>
 
-#include <SFML/Graphics.hpp>
-
+#include "InlineList.h"
 #include "Piece.h"
+#include "Rules.h"
+#include "Square.h"
+
+// The smallest unsigned type with a bit for every playable square of a
+// Size x Size board.
+template <int Size>
+using BitboardFor = std::conditional_t<(Size * Size / 2 <= 32), std::uint32_t, std::uint64_t>;
 
-class Board
+// A board of Size x Size squares played under Rules (Rules.h). Both are fixed
+// at compile time, so every variant gets a move generator of its own with no
+// rule checks left in it. The variants are instantiated in Board.cpp; Board is
+// the one the game, the engine and the tools play.
+template <int Size, typename Rules>
+class BasicBoard
 {
 public:
+    // One bit per playable (dark) square, numbered row-major from the top-left.
+    using Bitboard = BitboardFor<Size>;
+
+    static constexpr int SIZE = Size;
+    static constexpr int SQUARES = SIZE * SIZE / 2;
+    // Men fill every row but the middle two.
+    static constexpr int PIECES_PER_SIDE = (SIZE / 2 - 1) * (SIZE / 2);
+    static constexpr int MAX_HOPS = PIECES_PER_SIDE;
+
+    // A complete move. Captures list every hop of the sequence: the square
+    // landed on and the square jumped, as square indices, with `to` equal to
+    // the last landing square, so the whole sequence is applied in one step.
     struct Move
     {
-        sf::Vector2i from{};
-        sf::Vector2i to{};
+        Square from{};
+        Square to{};
         bool isCapture = false;
-        sf::Vector2i captured{-1, -1};
+        bool promotes = false;
+        std::uint8_t hopCount = 0;
+        std::array<std::uint8_t, MAX_HOPS> landings{};
+        std::array<std::uint8_t, MAX_HOPS> jumped{};
+
+        // Same piece, same path; hop data past hopCount is ignored.
+        bool operator==(const Move& other) const;
+    };
+
+    // A king sees at most 2 * SIZE - 3 squares along its diagonals, which bounds
+    // the single-hop moves of one piece and so the quiet moves of a side. The
+    // capture sequences of flying kings can branch much further; a list that
+    // outgrows this moves to the heap, so no legal move is ever dropped.
+    static constexpr int INLINE_MOVES = PIECES_PER_SIDE * (2 * SIZE - 3);
+
+    using MoveList = InlineList<Move, INLINE_MOVES>;
+
+    // The counts one side's static evaluation is built from. Every piece
+    // adds a fixed amount that depends only on its color, kind and square, so
+    // the totals are kept up to date move by move like the hash.
+    struct EvalTerms
+    {
+        std::uint8_t men = 0;
+        std::uint8_t kings = 0;
+        std::uint8_t tempo = 0;    // rows advanced by men, summed
+        std::uint8_t backRank = 0; // men still on their own back rank
+        std::uint8_t center = 0;   // pieces on the middle squares of the two middle rows
+
+        bool operator==(const EvalTerms& other) const = default;
     };
 
-    static constexpr int SIZE = 8;
+    // What makeMove changed that the move itself does not say: which of the
+    // captured pieces were kings, whether the mover was crowned, and the hash,
+    // evaluation terms and move summaries of the position before it.
+    struct Undo
+    {
+        std::uint8_t from = 0;
+        std::uint8_t to = 0;
+        bool promoted = false;
+        std::uint8_t summariesValid = 0;
+        Bitboard captured = 0;
+        Bitboard capturedKings = 0;
+        std::uint64_t hash = 0;
+        std::array<EvalTerms, 2> terms{};
+        std::array<Bitboard, 2> captureSources{};
+        std::array<bool, 2> hasMoves{};
+    };
 
-    Board();
+    BasicBoard();
     void reset();
-    void draw(sf::RenderWindow& window,
-              float cellSize,
-              const std::optional<sf::Vector2i>& selected,
-              const std::vector<sf::Vector2i>& highlightSquares) const;
-    const Piece* pieceAt(sf::Vector2i position) const;
-    static bool isInside(sf::Vector2i position);
-    std::vector<Move> getMovesForPiece(sf::Vector2i from, bool capturesOnly) const;
+    void setPosition(Bitboard first, Bitboard second, Bitboard kings, PieceColor sideToMove);
+    std::optional<Piece> pieceAt(Square position) const;
+    static bool isInside(Square position);
+    static bool isDarkSquare(int row, int col);
+    static int squareIndex(Square position);
+    static Square squarePosition(int square);
+    std::vector<Move> getMovesForPiece(Square from, bool capturesOnly) const;
+    void getMovesForPiece(Square from, bool capturesOnly, MoveList& moves) const;
     std::vector<Move> getAllMoves(PieceColor color, bool capturesOnly) const;
+    void getAllMoves(PieceColor color, bool capturesOnly, MoveList& moves) const;
+    void getLegalMoves(PieceColor color, MoveList& moves) const;
+    // Checks that the move fits the position before playing it, so it is safe
+    // for moves parsed from user input.
     bool applyMove(const Move& move);
+    // In-place make/unmake for search. makeMove trusts the move to come from
+    // the generators for this position; unmakeMove restores the position,
+    // hash and cached summaries exactly, and must be called in reverse order.
+    Undo makeMove(const Move& move);
+    void unmakeMove(const Undo& undo);
+    // Answered from a per-side summary computed on first use and dropped by
+    // any change to the pieces, so repeated queries between moves are free.
     bool hasCaptureMoves(PieceColor color) const;
     bool playerHasMoves(PieceColor color) const;
     int countPieces(PieceColor color) const;
+    Bitboard piecesOf(PieceColor color) const;
+    Bitboard kings() const;
+    PieceColor sideToMove() const;
+    void setSideToMove(PieceColor color);
+    // Zobrist key of the pieces and side to move, kept up to date incrementally.
+    std::uint64_t hash() const;
+    std::uint64_t computeHash() const;
+    // Also kept up to date incrementally; compute recounts from scratch.
+    const EvalTerms& evalTerms(PieceColor color) const;
+    EvalTerms computeEvalTerms(PieceColor color) const;
 
 private:
-    using Grid = std::array<std::array<std::optional<Piece>, SIZE>, SIZE>;
+    // What a side can do in the current position.
+    struct SideSummary
+    {
+        Bitboard captureSources = 0;
+        bool hasMoves = false;
+    };
 
-    Grid m_grid{};
+    Bitboard m_first = 0;
+    Bitboard m_second = 0;
+    Bitboard m_kings = 0;
+    PieceColor m_sideToMove = PieceColor::First;
+    std::uint64_t m_hash = 0;
+    std::array<EvalTerms, 2> m_terms{}; // indexed First, Second
+    // Filled lazily by const queries; a bit per PieceColor marks a valid entry.
+    // Boards are never shared between threads, so no synchronisation is needed.
+    mutable std::array<SideSummary, 2> m_summaries{};
+    mutable std::uint8_t m_summariesValid = 0;
 
-    static bool isDarkSquare(int row, int col);
-    std::vector<sf::Vector2i> moveDirectionsForPiece(const Piece& piece) const;
-    void promoteIfNeeded(sf::Vector2i position);
+    const SideSummary& summary(PieceColor color) const;
+    void invalidateSummaries();
+
+    Bitboard emptySquares() const;
+    Bitboard captureSources(PieceColor color) const;
+    void appendPieceMoves(int square, bool capturesOnly, MoveList& moves) const;
+    void appendCaptureSequences(int square,
+                                bool isKing,
+                                PieceColor color,
+                                Bitboard enemy,
+                                Bitboard empty,
+                                Move& move,
+                                MoveList& moves) const;
+    void crown(int square);
+    void switchSideToMove();
 };
+
+extern template class BasicBoard<8, HouseRules>;
+extern template class BasicBoard<8, EnglishRules>;
+extern template class BasicBoard<8, RussianRules>;
+extern template class BasicBoard<10, InternationalRules>;
+
+using Board = BasicBoard<8, HouseRules>;
+using EnglishBoard = BasicBoard<8, EnglishRules>;
+using RussianBoard = BasicBoard<8, RussianRules>;
+using InternationalBoard = BasicBoard<10, InternationalRules>;
@@ -0,0 +1,194 @@
+#include "BoardRenderer.h"
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <numbers>
+
+#include "Profiler.h"
+
+namespace
+{
+constexpr float SELECTION_OUTLINE = 4.0f;
+// Same tessellation as sf::CircleShape's default.
+constexpr std::size_t CIRCLE_POINTS = 30;
+
+const sf::Color LIGHT_SQUARE(245, 230, 200);
+const sf::Color DARK_SQUARE(101, 67, 33);
+const sf::Color SELECTION(255, 215, 0, 200);
+const sf::Color HIGHLIGHT(255, 215, 0, 120);
+
+using UnitCircle = std::array<sf::Vector2f, CIRCLE_POINTS + 1>;
+
+// Points on the unit circle, with the first repeated at the end so that
+// segment i runs from point i to point i + 1.
+const UnitCircle& unitCircle()
+{
+    static const UnitCircle points = [] {
+        UnitCircle result;
+        for (std::size_t i = 0; i <= CIRCLE_POINTS; ++i)
+        {
+            const float angle = 2.f * std::numbers::pi_v<float> * static_cast<float>(i % CIRCLE_POINTS)
+                              / static_cast<float>(CIRCLE_POINTS);
+            result[i] = {std::cos(angle), std::sin(angle)};
+        }
+        return result;
+    }();
+    return points;
+}
+
+void appendTriangle(sf::VertexArray& vertices, sf::Vector2f a, sf::Vector2f b, sf::Vector2f c, sf::Color color)
+{
+    vertices.append({a, color, {}});
+    vertices.append({b, color, {}});
+    vertices.append({c, color, {}});
+}
+
+void appendRect(sf::VertexArray& vertices, sf::Vector2f topLeft, sf::Vector2f size, sf::Color color)
+{
+    const sf::Vector2f topRight{topLeft.x + size.x, topLeft.y};
+    const sf::Vector2f bottomLeft{topLeft.x, topLeft.y + size.y};
+    const sf::Vector2f bottomRight{topLeft.x + size.x, topLeft.y + size.y};
+    appendTriangle(vertices, topLeft, topRight, bottomRight, color);
+    appendTriangle(vertices, topLeft, bottomRight, bottomLeft, color);
+}
+
+void appendDisc(sf::VertexArray& vertices, sf::Vector2f center, float radius, sf::Color color)
+{
+    const UnitCircle& circle = unitCircle();
+    for (std::size_t i = 0; i < CIRCLE_POINTS; ++i)
+    {
+        appendTriangle(vertices, center, center + circle[i] * radius, center + circle[i + 1] * radius, color);
+    }
+}
+
+// The band between two radii, as sf::Shape draws an outline outside its fill.
+void appendRing(sf::VertexArray& vertices, sf::Vector2f center, float inner, float outer, sf::Color color)
+{
+    const UnitCircle& circle = unitCircle();
+    for (std::size_t i = 0; i < CIRCLE_POINTS; ++i)
+    {
+        const sf::Vector2f innerA = center + circle[i] * inner;
+        const sf::Vector2f innerB = center + circle[i + 1] * inner;
+        const sf::Vector2f outerA = center + circle[i] * outer;
+        const sf::Vector2f outerB = center + circle[i + 1] * outer;
+        appendTriangle(vertices, innerA, outerA, outerB, color);
+        appendTriangle(vertices, innerA, outerB, innerB, color);
+    }
+}
+
+sf::Vector2f cellCenter(const Square& square, float cellSize)
+{
+    return {(static_cast<float>(square.col) + 0.5f) * cellSize, (static_cast<float>(square.row) + 0.5f) * cellSize};
+}
+}
+
+void BoardRenderer::draw(sf::RenderTarget& target,
+                         const Board& board,
+                         float cellSize,
+                         const std::optional<Square>& selected,
+                         const std::vector<Square>& highlightSquares)
+{
+    CHECKERS_PROFILE_SCOPE("BoardRenderer::draw");
+    if (cellSize != m_cellSize)
+    {
+        buildSquares(cellSize);
+        m_piecesBuilt = false;
+        const auto side = static_cast<unsigned>(std::lround(cellSize * Board::SIZE));
+        m_textureReady = m_texture.resize({side, side});
+    }
+
+    const bool unchanged = m_piecesBuilt && board.piecesOf(PieceColor::First) == m_first
+                        && board.piecesOf(PieceColor::Second) == m_second && board.kings() == m_kings
+                        && selected == m_selected && highlightSquares == m_highlights;
+    if (!unchanged)
+    {
+        buildPieces(board, cellSize, selected, highlightSquares);
+        if (m_textureReady)
+        {
+            m_texture.clear();
+            m_texture.draw(m_squares);
+            m_texture.draw(m_pieces);
+            m_texture.display();
+        }
+    }
+
+    if (m_textureReady)
+    {
+        target.draw(sf::Sprite(m_texture.getTexture()));
+    }
+    else
+    {
+        target.draw(m_squares);
+        target.draw(m_pieces);
+    }
+}
+
+void BoardRenderer::buildSquares(float cellSize)
+{
+    m_cellSize = cellSize;
+    m_squares.clear();
+    for (int row = 0; row < Board::SIZE; ++row)
+    {
+        for (int col = 0; col < Board::SIZE; ++col)
+        {
+            appendRect(m_squares,
+                       {static_cast<float>(col) * cellSize, static_cast<float>(row) * cellSize},
+                       {cellSize, cellSize},
+                       Board::isDarkSquare(row, col) ? DARK_SQUARE : LIGHT_SQUARE);
+        }
+    }
+}
+
+void BoardRenderer::buildPieces(const Board& board,
+                                float cellSize,
+                                const std::optional<Square>& selected,
+                                const std::vector<Square>& highlightSquares)
+{
+    using Bitboard = Board::Bitboard;
+
+    m_piecesBuilt = true;
+    m_first = board.piecesOf(PieceColor::First);
+    m_second = board.piecesOf(PieceColor::Second);
+    m_kings = board.kings();
+    m_selected = selected;
+    m_highlights = highlightSquares;
+    m_pieces.clear();
+
+    if (selected)
+    {
+        // A frame around the cell, outside it like an sf::Shape outline.
+        const float left = static_cast<float>(selected->col) * cellSize - SELECTION_OUTLINE;
+        const float top = static_cast<float>(selected->row) * cellSize - SELECTION_OUTLINE;
+        const float outer = cellSize + 2.f * SELECTION_OUTLINE;
+        appendRect(m_pieces, {left, top}, {outer, SELECTION_OUTLINE}, SELECTION);
+        appendRect(m_pieces, {left, top + outer - SELECTION_OUTLINE}, {outer, SELECTION_OUTLINE}, SELECTION);
+        appendRect(m_pieces, {left, top + SELECTION_OUTLINE}, {SELECTION_OUTLINE, cellSize}, SELECTION);
+        appendRect(m_pieces, {left + outer - SELECTION_OUTLINE, top + SELECTION_OUTLINE}, {SELECTION_OUTLINE, cellSize}, SELECTION);
+    }
+
+    for (const auto& square : highlightSquares)
+    {
+        appendDisc(m_pieces, cellCenter(square, cellSize), cellSize * 0.2f, HIGHLIGHT);
+    }
+
+    const float radius = cellSize * 0.38f;
+    const float innerRadius = radius * 0.5f;
+    for (Bitboard pieces = m_first | m_second; pieces != 0; pieces &= pieces - 1)
+    {
+        const int index = std::countr_zero(pieces);
+        const Bitboard bit = Bitboard{1} << index;
+        const sf::Vector2f center = cellCenter(Board::squarePosition(index), cellSize);
+        const bool isFirst = (m_first & bit) != 0;
+        const bool isKing = (m_kings & bit) != 0;
+
+        appendDisc(m_pieces, center, radius, isFirst ? sf::Color(220, 200, 170) : sf::Color(120, 70, 50));
+        appendRing(m_pieces, center, radius, radius + (isKing ? 4.f : 2.5f), sf::Color(60, 40, 25));
+
+        if (isKing)
+        {
+            appendDisc(m_pieces, center, innerRadius, isFirst ? sf::Color(240, 220, 190) : sf::Color(140, 90, 70));
+            appendRing(m_pieces, center, innerRadius, innerRadius + 1.5f, sf::Color(80, 50, 30));
+        }
+    }
+}
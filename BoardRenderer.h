@@ -0,0 +1,48 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+#include "Board.h"
+
+// Draws a Board with SFML. Kept apart from Board so the rules build and link
+// without any graphics libraries.
+//
+// The scene is held in two triangle batches: the checkerboard, built once per
+// cell size, and the selection, highlights and pieces, rebuilt only when the
+// position or selection differs from the last call. Both are rendered into a
+// texture at that point, so an unchanged board is a single textured quad.
+class BoardRenderer
+{
+public:
+    void draw(sf::RenderTarget& target,
+              const Board& board,
+              float cellSize,
+              const std::optional<Square>& selected,
+              const std::vector<Square>& highlightSquares);
+
+private:
+    void buildSquares(float cellSize);
+    void buildPieces(const Board& board,
+                     float cellSize,
+                     const std::optional<Square>& selected,
+                     const std::vector<Square>& highlightSquares);
+
+    sf::VertexArray m_squares{sf::PrimitiveType::Triangles};
+    sf::VertexArray m_pieces{sf::PrimitiveType::Triangles};
+    sf::RenderTexture m_texture;
+    // False if the texture could not be created; the batches are then drawn
+    // straight to the target.
+    bool m_textureReady = false;
+
+    // What m_squares and m_pieces were last built from.
+    float m_cellSize = 0.f;
+    bool m_piecesBuilt = false;
+    Board::Bitboard m_first = 0;
+    Board::Bitboard m_second = 0;
+    Board::Bitboard m_kings = 0;
+    std::optional<Square> m_selected;
+    std::vector<Square> m_highlights;
+};
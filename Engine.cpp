@@ -0,0 +1,497 @@
+#include "Engine.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "Stats.h"
+
+namespace
+{
+constexpr int INFINITE_SCORE = Engine::WIN_SCORE + 1;
+
+// The clock and the node limit are only checked every this many nodes per thread.
+constexpr std::uint64_t BUDGET_CHECK_INTERVAL = 1024;
+
+PieceColor opponent(PieceColor color)
+{
+    return color == PieceColor::First ? PieceColor::Second : PieceColor::First;
+}
+
+// Win scores are stored relative to the node rather than the root so they stay
+// correct when the position is reached at a different ply.
+int toTableScore(int score, int ply)
+{
+    if (score >= Engine::WIN_SCORE - Engine::MAX_PLY)
+    {
+        return score + ply;
+    }
+    if (score <= -Engine::WIN_SCORE + Engine::MAX_PLY)
+    {
+        return score - ply;
+    }
+    return score;
+}
+
+int fromTableScore(int score, int ply)
+{
+    if (score >= Engine::WIN_SCORE - Engine::MAX_PLY)
+    {
+        return score - ply;
+    }
+    if (score <= -Engine::WIN_SCORE + Engine::MAX_PLY)
+    {
+        return score + ply;
+    }
+    return score;
+}
+
+// Tablebase results as search scores: a win in n plies from here scores like
+// a win found by search at that ply.
+int tablebaseScore(const Tablebase::Result& result, int ply)
+{
+    const int plies = std::min(ply + result.distance, Engine::MAX_PLY);
+    switch (result.outcome)
+    {
+    case Tablebase::Outcome::Win:
+        return Engine::WIN_SCORE - plies;
+    case Tablebase::Outcome::Loss:
+        return -Engine::WIN_SCORE + plies;
+    case Tablebase::Outcome::Draw:
+        break;
+    }
+    return 0;
+}
+
+int sideScore(const Board::EvalTerms& terms)
+{
+    return terms.men * Engine::MAN_VALUE + terms.kings * Engine::KING_VALUE + terms.tempo * Engine::ADVANCE_BONUS +
+           terms.backRank * Engine::BACK_RANK_BONUS + terms.center * Engine::CENTER_BONUS;
+}
+}
+
+Engine::Engine()
+    : Engine(Limits{})
+{
+}
+
+Engine::Engine(Limits limits, std::size_t tableMegabytes)
+    : m_limits(limits)
+    , m_table(tableMegabytes)
+{
+}
+
+void Engine::setLimits(const Limits& limits)
+{
+    m_limits = limits;
+}
+
+const Engine::Limits& Engine::limits() const
+{
+    return m_limits;
+}
+
+Engine::Result Engine::search(const Board& board, PieceColor toMove, std::stop_token stop, const Progress& progress)
+{
+    return run(board, toMove, stop, progress, true);
+}
+
+Engine::Result Engine::ponder(const Board& board, PieceColor toMove, std::stop_token stop, const Progress& progress)
+{
+    return run(board, toMove, stop, progress, false);
+}
+
+void Engine::preparePonder()
+{
+    m_deadline.store(std::chrono::steady_clock::time_point::max(), std::memory_order_relaxed);
+}
+
+void Engine::ponderHit()
+{
+    m_deadline.store(std::chrono::steady_clock::now() + m_limits.maxTime, std::memory_order_relaxed);
+}
+
+std::optional<Board::Move> Engine::expectedMove(const Board& board) const
+{
+    const auto entry = m_table.probe(board.hash());
+    if (!entry || entry->move == 0)
+    {
+        return std::nullopt;
+    }
+    Board::MoveList moves;
+    board.getLegalMoves(board.sideToMove(), moves);
+    for (const auto& move : moves)
+    {
+        if (TranspositionTable::encodeMove(move) == entry->move)
+        {
+            return move;
+        }
+    }
+    return std::nullopt;
+}
+
+Engine::Result Engine::run(const Board& board, PieceColor toMove, std::stop_token stop, const Progress& progress, bool timed)
+{
+    const auto start = std::chrono::steady_clock::now();
+    // A ponder search runs on the deadline preparePonder() and ponderHit() set.
+    if (timed)
+    {
+        m_deadline.store(start + m_limits.maxTime, std::memory_order_relaxed);
+    }
+    m_stopRequested = false;
+    // A stop requested through the token, before the search or during it,
+    // ends it as stop() would.
+    const std::stop_callback onStop(stop, [this] { m_stopRequested = true; });
+    m_progress = progress ? &progress : nullptr;
+    m_sharedNodes = 0;
+    m_table.newSearch();
+
+    Board root = board;
+    root.setSideToMove(toMove);
+    Board::MoveList rootMoves;
+    root.getLegalMoves(toMove, rootMoves);
+
+    Result result;
+    if (rootMoves.empty())
+    {
+        result.score = -WIN_SCORE;
+        return result;
+    }
+    if (m_book)
+    {
+        if (const auto bookMove = m_book->pick(root, m_random))
+        {
+            result.bestMove = bookMove;
+            result.fromBook = true;
+            return result;
+        }
+    }
+    // A forced move needs no search.
+    if (rootMoves.size() == 1)
+    {
+        result.bestMove = rootMoves[0];
+        return result;
+    }
+
+    std::vector<Worker> workers(static_cast<std::size_t>(std::max(1, m_limits.threads)));
+    for (std::size_t i = 0; i < workers.size(); ++i)
+    {
+        workers[i].id = static_cast<int>(i);
+        workers[i].board = root;
+    }
+
+    {
+        std::vector<std::thread> helpers;
+        for (std::size_t i = 1; i < workers.size(); ++i)
+        {
+            helpers.emplace_back([this, &worker = workers[i], &rootMoves] { iterativeDeepening(worker, rootMoves); });
+        }
+        iterativeDeepening(workers[0], rootMoves);
+        // The main thread decides when the search is over.
+        m_stopRequested = true;
+        for (auto& helper : helpers)
+        {
+            helper.join();
+        }
+    }
+
+    // Prefer the deepest finished iteration; ties go to the lower thread id.
+    const Worker* chosen = &workers[0];
+    std::uint64_t totalNodes = 0;
+    for (const auto& worker : workers)
+    {
+        totalNodes += worker.nodes;
+        if (worker.result.depth > chosen->result.depth)
+        {
+            chosen = &worker;
+        }
+    }
+
+    result = chosen->result;
+    result.nodes = totalNodes;
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    result.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed);
+    const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    result.nodesPerSecond = micros > 0 ? totalNodes * 1000000 / static_cast<std::uint64_t>(micros) : 0;
+    m_progress = nullptr;
+    return result;
+}
+
+void Engine::stop()
+{
+    m_stopRequested = true;
+}
+
+void Engine::clearTable()
+{
+    m_table.clear();
+}
+
+void Engine::setTablebase(const Tablebase* tablebase)
+{
+    m_tablebase = tablebase;
+}
+
+void Engine::setOpeningBook(const OpeningBook* book)
+{
+    m_book = book;
+}
+
+int Engine::evaluate(const Board& board, PieceColor toMove)
+{
+    return sideScore(board.evalTerms(toMove)) - sideScore(board.evalTerms(opponent(toMove)));
+}
+
+bool Engine::isWinScore(int score)
+{
+    return score >= WIN_SCORE - MAX_PLY || score <= -WIN_SCORE + MAX_PLY;
+}
+
+void Engine::iterativeDeepening(Worker& worker, const Board::MoveList& rootMoves)
+{
+    Board& board = worker.board;
+    // Each thread reorders its own copy.
+    Board::MoveList& moves = worker.moves[0];
+    moves = rootMoves;
+    worker.result.bestMove = moves[0];
+
+    std::uint64_t previousIterationNodes = 0;
+    for (int depth = 1 + worker.id % 2; depth <= m_limits.maxDepth; ++depth)
+    {
+        const std::uint64_t nodesBefore = worker.nodes;
+        orderMoves(moves, TranspositionTable::encodeMove(*worker.result.bestMove));
+
+        int alpha = -INFINITE_SCORE;
+        Board::Move iterationBest = moves[0];
+        for (const auto& move : moves)
+        {
+            const Board::Undo undo = board.makeMove(move);
+            const int score = -negamax(worker, depth - 1, 1, -INFINITE_SCORE, -alpha);
+            board.unmakeMove(undo);
+            if (worker.aborted)
+            {
+                break;
+            }
+            if (score > alpha)
+            {
+                alpha = score;
+                iterationBest = move;
+            }
+        }
+
+        // An interrupted iteration is incomplete, so keep the last finished one.
+        if (worker.aborted)
+        {
+            break;
+        }
+
+        worker.result.bestMove = iterationBest;
+        worker.result.score = alpha;
+        worker.result.depth = depth;
+        const std::uint64_t iterationNodes = worker.nodes - nodesBefore;
+        if (previousIterationNodes > 0)
+        {
+            worker.result.branchingFactor
+                = static_cast<double>(iterationNodes) / static_cast<double>(previousIterationNodes);
+        }
+        previousIterationNodes = iterationNodes;
+        if (worker.id == 0 && m_progress)
+        {
+            Result iteration = worker.result;
+            iteration.nodes = worker.nodes;
+            (*m_progress)(iteration);
+        }
+        m_table.store(board.hash(), depth, alpha, TranspositionTable::Bound::Exact,
+                      TranspositionTable::encodeMove(iterationBest));
+        if (isWinScore(alpha))
+        {
+            break;
+        }
+    }
+}
+
+int Engine::negamax(Worker& worker, int depth, int ply, int alpha, int beta)
+{
+    if (m_tablebase)
+    {
+        if (const auto result = m_tablebase->probe(worker.board))
+        {
+            ++worker.nodes;
+            Stats::add(Stats::Counter::Nodes);
+            Stats::add(Stats::Counter::TablebaseHits);
+            return tablebaseScore(*result, ply);
+        }
+    }
+    if (depth <= 0)
+    {
+        return quiescence(worker, ply, alpha, beta);
+    }
+    if (outOfBudget(worker))
+    {
+        return 0;
+    }
+    ++worker.nodes;
+    Stats::add(Stats::Counter::Nodes);
+    Board& board = worker.board;
+
+    const std::uint64_t key = board.hash();
+    std::uint16_t tableMove = 0;
+    Stats::add(Stats::Counter::TableProbes);
+    if (const auto entry = m_table.probe(key))
+    {
+        Stats::add(Stats::Counter::TableHits);
+        tableMove = entry->move;
+        if (entry->depth >= depth)
+        {
+            const int score = fromTableScore(entry->score, ply);
+            if (entry->bound == TranspositionTable::Bound::Exact
+                || (entry->bound == TranspositionTable::Bound::Lower && score >= beta)
+                || (entry->bound == TranspositionTable::Bound::Upper && score <= alpha))
+            {
+                return score;
+            }
+        }
+    }
+
+    if (ply >= MAX_PLY)
+    {
+        return board.playerHasMoves(board.sideToMove()) ? evaluate(board, board.sideToMove()) : -WIN_SCORE + ply;
+    }
+    Board::MoveList& moves = worker.moves[ply];
+    board.getLegalMoves(board.sideToMove(), moves);
+    if (moves.empty())
+    {
+        return -WIN_SCORE + ply;
+    }
+
+    orderMoves(moves, tableMove);
+
+    const int originalAlpha = alpha;
+    int best = -INFINITE_SCORE;
+    std::uint16_t bestMove = 0;
+    for (const auto& move : moves)
+    {
+        const Board::Undo undo = board.makeMove(move);
+        const int score = -negamax(worker, depth - 1, ply + 1, -beta, -alpha);
+        board.unmakeMove(undo);
+        if (worker.aborted)
+        {
+            return 0;
+        }
+
+        if (score > best)
+        {
+            best = score;
+            bestMove = TranspositionTable::encodeMove(move);
+        }
+        alpha = std::max(alpha, score);
+        if (alpha >= beta)
+        {
+            Stats::add(Stats::Counter::Cutoffs);
+            break;
+        }
+    }
+
+    const auto bound = best <= originalAlpha ? TranspositionTable::Bound::Upper
+                     : best >= beta          ? TranspositionTable::Bound::Lower
+                                             : TranspositionTable::Bound::Exact;
+    m_table.store(key, depth, toTableScore(best, ply), bound, bestMove);
+    return best;
+}
+
+int Engine::quiescence(Worker& worker, int ply, int alpha, int beta)
+{
+    if (outOfBudget(worker))
+    {
+        return 0;
+    }
+    ++worker.nodes;
+    Stats::add(Stats::Counter::Nodes);
+    Stats::add(Stats::Counter::QuiescenceNodes);
+    Board& board = worker.board;
+
+    // Captures are compulsory, so a quiet position is scored as it stands and
+    // a position with a capture has no stand-pat option.
+    const PieceColor color = board.sideToMove();
+    if (!board.hasCaptureMoves(color))
+    {
+        if (!board.playerHasMoves(color))
+        {
+            return -WIN_SCORE + ply;
+        }
+        return evaluate(board, color);
+    }
+    if (ply >= MAX_PLY)
+    {
+        return evaluate(board, color);
+    }
+
+    Board::MoveList& captures = worker.moves[ply];
+    board.getLegalMoves(color, captures);
+    orderMoves(captures, 0);
+
+    int best = -INFINITE_SCORE;
+    for (const auto& move : captures)
+    {
+        const Board::Undo undo = board.makeMove(move);
+        const int score = -quiescence(worker, ply + 1, -beta, -alpha);
+        board.unmakeMove(undo);
+        if (worker.aborted)
+        {
+            return 0;
+        }
+
+        best = std::max(best, score);
+        alpha = std::max(alpha, score);
+        if (alpha >= beta)
+        {
+            Stats::add(Stats::Counter::Cutoffs);
+            break;
+        }
+    }
+    return best;
+}
+
+bool Engine::outOfBudget(Worker& worker)
+{
+    if (worker.aborted)
+    {
+        return true;
+    }
+
+    if (m_stopRequested.load(std::memory_order_relaxed))
+    {
+        worker.aborted = true;
+    }
+    else if (worker.nodes % BUDGET_CHECK_INTERVAL == 0)
+    {
+        // Node counts are pooled in batches so the limit applies to all threads together.
+        const std::uint64_t pooled = m_sharedNodes.fetch_add(BUDGET_CHECK_INTERVAL, std::memory_order_relaxed);
+        worker.aborted = (m_limits.maxNodes != 0 && pooled >= m_limits.maxNodes)
+            || std::chrono::steady_clock::now() >= m_deadline.load(std::memory_order_relaxed);
+    }
+    return worker.aborted;
+}
+
+void Engine::orderMoves(Board::MoveList& moves, std::uint16_t preferred)
+{
+    // Longer capture sequences and promotions first; they tend to refute quickly.
+    std::stable_sort(moves.begin(), moves.end(), [](const Board::Move& a, const Board::Move& b) {
+        if (a.hopCount != b.hopCount)
+        {
+            return a.hopCount > b.hopCount;
+        }
+        return a.promotes && !b.promotes;
+    });
+
+    if (preferred != 0)
+    {
+        auto found = std::find_if(moves.begin(), moves.end(), [preferred](const Board::Move& move) {
+            return TranspositionTable::encodeMove(move) == preferred;
+        });
+        if (found != moves.end())
+        {
+            std::rotate(moves.begin(), found, found + 1);
+        }
+    }
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <random>
+#include <stop_token>
+
+#include "Board.h"
+#include "OpeningBook.h"
+#include "Tablebase.h"
+#include "TranspositionTable.h"
+
+// Negamax alpha-beta search with iterative deepening, a transposition table
+// and a capture-only quiescence search. Searches run on private copies of the
+// board using makeMove/unmakeMove, so the caller's board is never touched.
+//
+// With more than one thread the search is Lazy SMP: every thread runs its own
+// iterative deepening on its own board and they cooperate only through the
+// shared transposition table. Helpers start one ply deeper on alternate
+// threads so they fill the table ahead of the main thread.
+//
+// A search can be stopped from another thread, by stop() or through the
+// stop_token it was given, and reports each completed iteration of the main
+// thread as it goes.
+//
+// Pondering searches the position after the opponent's expected reply while
+// the opponent is still thinking, with no time limit. If the opponent plays
+// that reply, ponderHit() gives the running search its normal time budget
+// from then on, so the time spent pondering is thinking time gained; if not,
+// the search is stopped and only its transposition table entries remain.
+//
+// With a tablebase attached, positions it covers are scored exactly below the
+// root instead of being searched. With an opening book attached, a book move
+// for the root is played without searching at all.
+class Engine
+{
+public:
+    struct Limits
+    {
+        int maxDepth = 64;
+        std::uint64_t maxNodes = 0; // 0 means no node limit
+        std::chrono::milliseconds maxTime{1000};
+        int threads = 1;
+    };
+
+    struct Result
+    {
+        std::optional<Board::Move> bestMove;
+        int score = 0;
+        int depth = 0;
+        std::uint64_t nodes = 0; // summed over all threads
+        std::uint64_t nodesPerSecond = 0;
+        // Nodes of the deepest iteration over those of the one before it, for
+        // the thread whose result was chosen; 0 with fewer than two iterations.
+        double branchingFactor = 0.0;
+        std::chrono::milliseconds elapsed{0};
+        bool fromBook = false;
+    };
+
+    // Called on the searching thread with the result of each completed
+    // iteration; it must be quick, as the search waits for it.
+    using Progress = std::function<void(const Result& iteration)>;
+
+    static constexpr int WIN_SCORE = 30000;
+    static constexpr int MAX_PLY = 128;
+
+    // Weights of evaluate(), also used by BatchEvaluator.
+    static constexpr int MAN_VALUE = 100;
+    static constexpr int KING_VALUE = 300;
+    static constexpr int ADVANCE_BONUS = 3;   // per man per row advanced
+    static constexpr int BACK_RANK_BONUS = 10; // per man still on its own back rank
+    static constexpr int CENTER_BONUS = 5;
+
+    Engine();
+    explicit Engine(Limits limits, std::size_t tableMegabytes = TranspositionTable::DEFAULT_MEGABYTES);
+
+    void setLimits(const Limits& limits);
+    const Limits& limits() const;
+    Result search(const Board& board, PieceColor toMove, std::stop_token stop = {}, const Progress& progress = {});
+    // Like search, but untimed until ponderHit() is called. preparePonder()
+    // must be called first, before ponder() is handed to another thread.
+    Result ponder(const Board& board, PieceColor toMove, std::stop_token stop, const Progress& progress = {});
+    // Takes the clock off for the next ponder(). ponder() leaves the clock
+    // alone, so a ponderHit() that comes before its thread gets going counts.
+    void preparePonder();
+    // Safe to call from any thread once preparePonder() has returned.
+    void ponderHit();
+    void stop();
+    // The transposition table's move for the position, if it is legal there:
+    // after a search, the reply it expects to the move it chose.
+    std::optional<Board::Move> expectedMove(const Board& board) const;
+    void clearTable();
+    // Not owned; must outlive the searches. nullptr detaches it.
+    void setTablebase(const Tablebase* tablebase);
+    // Not owned either; book moves are picked at random by weight.
+    void setOpeningBook(const OpeningBook* book);
+
+    // Static score of the position from `toMove`'s point of view.
+    static int evaluate(const Board& board, PieceColor toMove);
+    static bool isWinScore(int score);
+
+private:
+    // Per-thread search state; nothing in here is shared.
+    struct Worker
+    {
+        int id = 0;
+        Board board;
+        std::uint64_t nodes = 0;
+        bool aborted = false;
+        Result result; // deepest completed iteration
+        // One move list per ply, so search frames stay small on thread stacks;
+        // ply 0 holds the root moves.
+        std::unique_ptr<Board::MoveList[]> moves = std::make_unique_for_overwrite<Board::MoveList[]>(MAX_PLY);
+    };
+
+    Result run(const Board& board, PieceColor toMove, std::stop_token stop, const Progress& progress, bool timed);
+    void iterativeDeepening(Worker& worker, const Board::MoveList& rootMoves);
+    int negamax(Worker& worker, int depth, int ply, int alpha, int beta);
+    int quiescence(Worker& worker, int ply, int alpha, int beta);
+    bool outOfBudget(Worker& worker);
+    static void orderMoves(Board::MoveList& moves, std::uint16_t preferred);
+
+    Limits m_limits;
+    TranspositionTable m_table;
+    const Tablebase* m_tablebase = nullptr;
+    const OpeningBook* m_book = nullptr;
+    const Progress* m_progress = nullptr; // of the running search
+    std::mt19937 m_random{std::random_device{}()};
+    std::atomic<bool> m_stopRequested{false};
+    std::atomic<std::uint64_t> m_sharedNodes{0};
+    // Atomic so that ponderHit() can set it while threads are searching.
+    std::atomic<std::chrono::steady_clock::time_point> m_deadline;
+};
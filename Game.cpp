@@ -1,18 +1,46 @@
 #include "Game.h"
 
+#include <fstream>
 #include <iostream>
 
+#include "Notation.h"
+#include "Pdn.h"
+
 namespace
 {
 constexpr unsigned WINDOW_SIZE = 800;
 constexpr char FONT_PATH[] = "assets/DejaVuSans.ttf";
 constexpr float TRANSITION_DURATION = 1.0f;
+// Upper bound on how long an idle window blocks waiting for input.
+const sf::Time IDLE_WAIT = sf::milliseconds(250);
+// While the computer thinks, the window wakes once a frame to look for its move.
+const sf::Time THINKING_WAIT = sf::milliseconds(16);
+const sf::Color BACKGROUND(240, 235, 220);
 }
 
 Game::Game()
+    : Game(GameOptions{})
+{
+}
+
+Game::Game(const GameOptions& options)
     : m_window(sf::VideoMode({WINDOW_SIZE, WINDOW_SIZE}), "SFML Checkers")
     , m_currentPlayer(PieceColor::First)
+    , m_engine(options.engineLimits)
+    , m_computerFirst(options.computerFirst)
+    , m_computerSecond(options.computerSecond)
+    , m_ponderEnabled(options.ponder)
+    , m_recordPath(options.recordPath)
+#ifdef CHECKERS_PROFILE
+    , m_tracePath(options.tracePath)
+#endif
 {
+#ifndef CHECKERS_PROFILE
+    if (!options.tracePath.empty())
+    {
+        std::cerr << "Warning: Unable to write a trace; build with -DCHECKERS_PROFILE to enable profiling.\n";
+    }
+#endif
     m_window.setFramerateLimit(60);
     m_cellSize = static_cast<float>(WINDOW_SIZE) / static_cast<float>(Board::SIZE);
 
@@ -43,6 +71,10 @@ Game::Game()
         sf::FloatRect rb = m_rematchButtonText->getLocalBounds();
         m_rematchButtonText->setOrigin({rb.size.x / 2.f, rb.size.y / 2.f});
 
+        m_gameOverText.emplace(m_font, "", 36);
+        m_gameOverText->setPosition({WINDOW_SIZE / 2.f, WINDOW_SIZE / 3.f});
+        m_gameOverText->setFillColor(sf::Color(245, 230, 200));
+
         m_nameInputLabel.emplace(m_font, "Enter First Player Name:", 32);
         sf::FloatRect labelBounds = m_nameInputLabel->getLocalBounds();
         m_nameInputLabel->setOrigin({labelBounds.size.x / 2.f, labelBounds.size.y / 2.f});
@@ -65,6 +97,39 @@ Game::Game()
                   << ". Turn text will be disabled.\n";
     }
 
+    if (!options.tablebasePath.empty())
+    {
+        if (m_tablebase.open(options.tablebasePath))
+        {
+            m_engine.setTablebase(&m_tablebase);
+        }
+        else
+        {
+            std::cerr << "Warning: Unable to open tablebase at " << options.tablebasePath
+                      << ". Endgames will be searched.\n";
+        }
+    }
+    if (!options.bookPath.empty())
+    {
+        if (m_book.open(options.bookPath))
+        {
+            m_engine.setOpeningBook(&m_book);
+        }
+        else
+        {
+            std::cerr << "Warning: Unable to open opening book at " << options.bookPath
+                      << ". Openings will be searched.\n";
+        }
+    }
+
+    m_layersReady = m_startLayer.texture.resize({WINDOW_SIZE, WINDOW_SIZE})
+                 && m_nameInputLayer.texture.resize({WINDOW_SIZE, WINDOW_SIZE})
+                 && m_gameOverLayer.texture.resize({WINDOW_SIZE, WINDOW_SIZE});
+    if (!m_layersReady)
+    {
+        std::cerr << "Warning: Unable to create off-screen layers. Screens will be drawn directly.\n";
+    }
+
     updateStatusText();
 
     m_startButton.setSize({220.f, 60.f});
@@ -73,6 +138,10 @@ Game::Game()
     m_startButton.setOutlineThickness(2.f);
     m_startButton.setOrigin({110.f, 30.f});
     m_startButton.setPosition({WINDOW_SIZE / 2.f, WINDOW_SIZE * 0.55f});
+    if (m_startButtonText)
+    {
+        m_startButtonText->setPosition(m_startButton.getPosition());
+    }
 
     m_transitionOverlay.setSize({static_cast<float>(WINDOW_SIZE), static_cast<float>(WINDOW_SIZE)});
     m_transitionOverlay.setFillColor(sf::Color(0, 0, 0, 0));
@@ -83,6 +152,10 @@ Game::Game()
     m_rematchButton.setOutlineThickness(3.f);
     m_rematchButton.setOrigin({140.f, 35.f});
     m_rematchButton.setPosition({WINDOW_SIZE / 2.f, WINDOW_SIZE * 0.65f});
+    if (m_rematchButtonText)
+    {
+        m_rematchButtonText->setPosition(m_rematchButton.getPosition());
+    }
 
     m_nameInputBox.setSize({400.f, 50.f});
     m_nameInputBox.setFillColor(sf::Color(245, 230, 200));
@@ -97,6 +170,10 @@ Game::Game()
     m_nameInputButton.setOutlineThickness(2.f);
     m_nameInputButton.setOrigin({90.f, 25.f});
     m_nameInputButton.setPosition({WINDOW_SIZE / 2.f, WINDOW_SIZE * 0.6f});
+    if (m_nameInputButtonText)
+    {
+        m_nameInputButtonText->setPosition(m_nameInputButton.getPosition());
+    }
 
     m_currentInputName = "";
     m_inputtingFirstName = true;
@@ -107,9 +184,20 @@ void Game::run()
     sf::Clock clock;
     while (m_window.isOpen())
     {
+        // Only block for long when nothing is moving on its own; an animation
+        // keeps the frame loop going, and a search in progress wakes it often.
+        const bool animating = isAnimating();
+        const bool searchDue = isComputerTurn() && !m_thinking;
+        processEvents(animating || searchDue ? sf::Time::Zero : m_thinking ? THINKING_WAIT : IDLE_WAIT);
+        collectThinking();
         float deltaTime = clock.restart().asSeconds();
-        processEvents();
-        
+        if (!animating)
+        {
+            // Time spent blocked must not count toward an animation that
+            // starts this frame.
+            deltaTime = 0.f;
+        }
+
         if (m_state == GameState::Transitioning)
         {
             m_transitionAlpha += m_transitionSpeed * deltaTime * 255.f;
@@ -119,6 +207,7 @@ void Game::run()
                 m_state = GameState::Playing;
             }
             m_transitionOverlay.setFillColor(sf::Color(0, 0, 0, static_cast<unsigned char>(m_transitionAlpha)));
+            m_dirty = true;
         }
         else if (m_state == GameState::Playing && m_transitionAlpha > 0.f)
         {
@@ -128,85 +217,142 @@ void Game::run()
                 m_transitionAlpha = 0.f;
             }
             m_transitionOverlay.setFillColor(sf::Color(0, 0, 0, static_cast<unsigned char>(m_transitionAlpha)));
+            m_dirty = true;
+        }
+
+        if (m_dirty)
+        {
+            render();
+            m_dirty = false;
+            CHECKERS_PROFILE_END_FRAME();
+        }
+
+        // Start thinking after the frame so the opponent's last move is
+        // already on screen.
+        if (isComputerTurn() && !m_thinking)
+        {
+            startThinking();
         }
-        
-        render();
     }
+
+    cancelThinking();
+
+#ifdef CHECKERS_PROFILE
+    if (!m_tracePath.empty() && !Profiler::instance().writeTrace(m_tracePath))
+    {
+        std::cerr << "Warning: Unable to write the trace to " << m_tracePath << ".\n";
+    }
+#endif
+}
+
+bool Game::isAnimating() const
+{
+    return m_state == GameState::Transitioning || (m_state == GameState::Playing && m_transitionAlpha > 0.f);
 }
 
-void Game::processEvents()
+void Game::processEvents(sf::Time wait)
 {
+    std::optional<sf::Event> waited;
+    if (wait != sf::Time::Zero)
+    {
+        waited = m_window.waitEvent(wait);
+    }
+
+    // A frame starts once there is something to do; idle waiting is not
+    // frame time.
+    CHECKERS_PROFILE_BEGIN_FRAME();
+    CHECKERS_PROFILE_SCOPE("processEvents");
+    if (waited)
+    {
+        handleEvent(*waited);
+    }
     while (const std::optional<sf::Event> event = m_window.pollEvent())
     {
-        if (event->is<sf::Event::Closed>())
-        {
-            m_window.close();
-        }
-        else if (const auto* textEntered = event->getIf<sf::Event::TextEntered>())
+        handleEvent(*event);
+    }
+}
+
+void Game::handleEvent(const sf::Event& event)
+{
+    // Anything but a plain mouse move may change the scene, or (resize,
+    // regained focus) may have lost the window's contents.
+    if (!event.is<sf::Event::MouseMoved>())
+    {
+        m_dirty = true;
+    }
+
+    if (event.is<sf::Event::Closed>())
+    {
+        m_window.close();
+    }
+#ifdef CHECKERS_PROFILE
+    else if (const auto* keyPressed = event.getIf<sf::Event::KeyPressed>();
+             keyPressed != nullptr && keyPressed->code == sf::Keyboard::Key::F3)
+    {
+        m_showProfiler = !m_showProfiler;
+    }
+#endif
+    else if (const auto* textEntered = event.getIf<sf::Event::TextEntered>())
+    {
+        if (m_state == GameState::NameInput)
         {
-            if (m_state == GameState::NameInput)
+            unsigned int unicode = textEntered->unicode;
+            if (unicode == 13 || unicode == 10)
             {
-                unsigned int unicode = textEntered->unicode;
-                if (unicode == 13 || unicode == 10)
-                {
-                    handleMouseClick({0, 0});
-                }
-                else if (unicode == 8)
+                handleMouseClick({0, 0});
+            }
+            else if (unicode == 8)
+            {
+                if (!m_currentInputName.empty())
                 {
-                    if (!m_currentInputName.empty())
+                    m_currentInputName.pop_back();
+                    if (m_nameInputText)
                     {
-                        m_currentInputName.pop_back();
-                        if (m_nameInputText)
-                        {
-                            m_nameInputText->setString(m_currentInputName);
-                            sf::FloatRect textBounds = m_nameInputText->getLocalBounds();
-                            m_nameInputText->setOrigin({textBounds.size.x / 2.f, textBounds.size.y / 2.f});
-                        }
+                        m_nameInputText->setString(m_currentInputName);
+                        sf::FloatRect textBounds = m_nameInputText->getLocalBounds();
+                        m_nameInputText->setOrigin({textBounds.size.x / 2.f, textBounds.size.y / 2.f});
                     }
                 }
-                else
-                {
-                    handleTextInput(unicode);
-                }
             }
-        }
-        else if (const auto* mousePressed = event->getIf<sf::Event::MouseButtonPressed>())
-        {
-            if (mousePressed->button == sf::Mouse::Button::Left)
+            else
             {
-                handleMouseClick(mousePressed->position);
+                handleTextInput(unicode);
             }
         }
-        else if (const auto* mouseMoved = event->getIf<sf::Event::MouseMoved>())
+    }
+    else if (const auto* mousePressed = event.getIf<sf::Event::MouseButtonPressed>())
+    {
+        if (mousePressed->button == sf::Mouse::Button::Left)
         {
-            if (m_state == GameState::StartScreen)
-            {
-                sf::Vector2f p(static_cast<float>(mouseMoved->position.x), static_cast<float>(mouseMoved->position.y));
-                if (m_startButton.getGlobalBounds().contains(p))
-                {
-                    m_startButton.setFillColor(sf::Color(120, 80, 50));
-                }
-                else
-                {
-                    m_startButton.setFillColor(sf::Color(101, 67, 33));
-                }
-            }
-            else if (m_state == GameState::NameInput)
-            {
-                sf::Vector2f p(static_cast<float>(mouseMoved->position.x), static_cast<float>(mouseMoved->position.y));
-                if (m_nameInputButton.getGlobalBounds().contains(p))
-                {
-                    m_nameInputButton.setFillColor(sf::Color(120, 80, 50));
-                }
-                else
-                {
-                    m_nameInputButton.setFillColor(sf::Color(101, 67, 33));
-                }
-            }
+            handleMouseClick(mousePressed->position);
+        }
+    }
+    else if (const auto* mouseMoved = event.getIf<sf::Event::MouseMoved>())
+    {
+        if (m_state == GameState::StartScreen)
+        {
+            updateHover(m_startButton, mouseMoved->position);
+        }
+        else if (m_state == GameState::NameInput)
+        {
+            updateHover(m_nameInputButton, mouseMoved->position);
         }
     }
 }
 
+void Game::updateHover(sf::RectangleShape& button, const sf::Vector2i& mousePos)
+{
+    const sf::Vector2f p(static_cast<float>(mousePos.x), static_cast<float>(mousePos.y));
+    const sf::Color fill = button.getGlobalBounds().contains(p) ? sf::Color(120, 80, 50) : sf::Color(101, 67, 33);
+    if (button.getFillColor() != fill)
+    {
+        button.setFillColor(fill);
+        m_startLayer.valid = false;
+        m_nameInputLayer.valid = false;
+        m_dirty = true;
+    }
+}
+
 void Game::handleTextInput(unsigned int unicode)
 {
     if (unicode >= 32 && unicode < 127 && m_currentInputName.length() < 20)
@@ -223,6 +369,7 @@ void Game::handleTextInput(unsigned int unicode)
 
 void Game::handleMouseClick(const sf::Vector2i& pixelPos)
 {
+    CHECKERS_PROFILE_SCOPE("handleMouseClick");
     if (m_state == GameState::StartScreen)
     {
         sf::Vector2f p(static_cast<float>(pixelPos.x), static_cast<float>(pixelPos.y));
@@ -236,6 +383,7 @@ void Game::handleMouseClick(const sf::Vector2i& pixelPos)
                 m_nameInputLabel->setString("Enter First Player Name:");
                 sf::FloatRect labelBounds = m_nameInputLabel->getLocalBounds();
                 m_nameInputLabel->setOrigin({labelBounds.size.x / 2.f, labelBounds.size.y / 2.f});
+                m_nameInputLayer.valid = false;
             }
             if (m_nameInputText)
             {
@@ -260,6 +408,7 @@ void Game::handleMouseClick(const sf::Vector2i& pixelPos)
                     m_nameInputLabel->setString("Enter Second Player Name:");
                     sf::FloatRect labelBounds = m_nameInputLabel->getLocalBounds();
                     m_nameInputLabel->setOrigin({labelBounds.size.x / 2.f, labelBounds.size.y / 2.f});
+                    m_nameInputLayer.valid = false;
                 }
                 if (m_nameInputText)
                 {
@@ -281,11 +430,15 @@ void Game::handleMouseClick(const sf::Vector2i& pixelPos)
         sf::Vector2f p(static_cast<float>(pixelPos.x), static_cast<float>(pixelPos.y));
         if (m_rematchButton.getGlobalBounds().contains(p))
         {
+            cancelThinking();
             m_board.reset();
+            m_legalMovesValid = false;
+            m_history.clear();
             m_currentPlayer = PieceColor::First;
             m_selectedSquare.reset();
             m_currentMoves.clear();
             m_forcedCaptureChain = false;
+            m_chainStep = 0;
             m_chainPiece = {-1, -1};
             m_gameOver = false;
             m_state = GameState::Playing;
@@ -294,14 +447,14 @@ void Game::handleMouseClick(const sf::Vector2i& pixelPos)
         return;
     }
 
-    if (m_gameOver || m_state != GameState::Playing)
+    if (m_gameOver || m_state != GameState::Playing || isComputerTurn())
     {
         return;
     }
 
     const int col = static_cast<int>(pixelPos.x / m_cellSize);
     const int row = static_cast<int>(pixelPos.y / m_cellSize);
-    sf::Vector2i boardPos(row, col);
+    const Square boardPos(row, col);
 
     if (!Board::isInside(boardPos))
     {
@@ -310,83 +463,69 @@ void Game::handleMouseClick(const sf::Vector2i& pixelPos)
 
     if (m_selectedSquare)
     {
+        Board::MoveList remaining;
         for (const auto& move : m_currentMoves)
         {
-            if (move.to == boardPos)
+            if (nextLanding(move) == boardPos)
             {
-                if (!m_board.applyMove(move))
-                {
-                    return;
-                }
-
-                const bool performedCapture = move.isCapture;
-
-                m_selectedSquare.reset();
-                m_currentMoves.clear();
-
-                checkForGameOver();
-                if (m_gameOver)
-                {
-                    updateStatusText();
-                    return;
-                }
-
-                if (performedCapture)
-                {
-                    auto followUp = m_board.getMovesForPiece(move.to, true);
-                    if (!followUp.empty())
-                    {
-                        m_selectedSquare = move.to;
-                        m_currentMoves = followUp;
-                        m_forcedCaptureChain = true;
-                        m_chainPiece = move.to;
-                        updateStatusText();
-                        return;
-                    }
-                }
-
-                m_forcedCaptureChain = false;
-                m_chainPiece = {-1, -1};
+                remaining.push_back(move);
+            }
+        }
 
-                PieceColor justPlayed = m_currentPlayer;
-                switchTurn();
+        if (!remaining.empty())
+        {
+            // A sequence that can continue must continue, so if one candidate
+            // ends on this square it is the only one left.
+            if (remaining[0].hopCount <= m_chainStep + 1)
+            {
+                playMove(remaining[0]);
+                return;
+            }
 
-                const int opponentPieces = m_board.countPieces(m_currentPlayer);
-                const bool opponentStuck = !m_board.playerHasMoves(m_currentPlayer);
-                if (opponentPieces == 0 || opponentStuck)
+            if (!m_forcedCaptureChain)
+            {
+                m_chainBoard = m_board;
+            }
+            Board::MoveList hops;
+            m_chainBoard.getMovesForPiece(m_chainPiece, true, hops);
+            for (const auto& hop : hops)
+            {
+                if (hop.to == boardPos)
                 {
-                    m_gameOver = true;
-                    m_state = GameState::GameOver;
-                    const std::string winner = (justPlayed == PieceColor::First ? m_playerFirstName : m_playerSecondName);
-                    if (opponentPieces == 0)
-                    {
-                        m_gameOverMessage = winner + " wins! Opponent has no pieces left.";
-                    }
-                    else
-                    {
-                        m_gameOverMessage = winner + " wins! Opponent has no legal moves.";
-                    }
-                    m_winner = justPlayed;
+                    m_chainBoard.applyMove(hop);
+                    break;
                 }
-                updateStatusText();
-                return;
             }
+
+            m_currentMoves = remaining;
+            ++m_chainStep;
+            m_selectedSquare = boardPos;
+            m_forcedCaptureChain = true;
+            m_chainPiece = boardPos;
+            updateStatusText();
+            return;
         }
     }
 
-    if (m_forcedCaptureChain && (!m_selectedSquare || boardPos != m_chainPiece))
+    if (m_forcedCaptureChain)
     {
         return;
     }
 
-    const Piece* piece = m_board.pieceAt(boardPos);
+    const std::optional<Piece> piece = m_board.pieceAt(boardPos);
     if (!piece || piece->getColor() != m_currentPlayer)
     {
         return;
     }
 
-    const bool capturesMandatory = m_board.hasCaptureMoves(m_currentPlayer);
-    auto moves = m_board.getMovesForPiece(boardPos, capturesMandatory);
+    Board::MoveList moves;
+    for (const auto& move : legalMoves())
+    {
+        if (move.from == boardPos)
+        {
+            moves.push_back(move);
+        }
+    }
     if (moves.empty())
     {
         return;
@@ -394,10 +533,248 @@ void Game::handleMouseClick(const sf::Vector2i& pixelPos)
 
     m_selectedSquare = boardPos;
     m_currentMoves = moves;
+    m_chainStep = 0;
     m_chainPiece = boardPos;
     updateStatusText();
 }
 
+void Game::playMove(const Board::Move& move)
+{
+    if (!m_board.applyMove(move))
+    {
+        return;
+    }
+    m_legalMovesValid = false;
+    m_dirty = true;
+    m_history.push_back(move);
+
+    // The ponder search is on the position after the reply it expected: keep
+    // it and start its clock if that reply was played, drop it otherwise.
+    if (m_pondering)
+    {
+        if (move == m_ponderMove)
+        {
+            m_pondering = false;
+            m_engine.ponderHit();
+        }
+        else
+        {
+            cancelThinking();
+        }
+    }
+
+    m_selectedSquare.reset();
+    m_currentMoves.clear();
+    m_forcedCaptureChain = false;
+    m_chainStep = 0;
+    m_chainPiece = {-1, -1};
+
+    checkForGameOver();
+    if (m_gameOver)
+    {
+        cancelThinking();
+        recordGame();
+        updateStatusText();
+        return;
+    }
+
+    PieceColor justPlayed = m_currentPlayer;
+    switchTurn();
+
+    const int opponentPieces = m_board.countPieces(m_currentPlayer);
+    const bool opponentStuck = !m_board.playerHasMoves(m_currentPlayer);
+    if (opponentPieces == 0 || opponentStuck)
+    {
+        m_gameOver = true;
+        m_state = GameState::GameOver;
+        const std::string winner = (justPlayed == PieceColor::First ? m_playerFirstName : m_playerSecondName);
+        if (opponentPieces == 0)
+        {
+            setGameOverMessage(winner + " wins! Opponent has no pieces left.");
+        }
+        else
+        {
+            setGameOverMessage(winner + " wins! Opponent has no legal moves.");
+        }
+        m_winner = justPlayed;
+        cancelThinking();
+        recordGame();
+    }
+    updateStatusText();
+}
+
+void Game::recordGame()
+{
+    if (m_recordPath.empty())
+    {
+        return;
+    }
+    std::ofstream out(m_recordPath, std::ios::app);
+    Pdn::write(out,
+               {{"Event", "Checkers"}, {"Black", m_playerFirstName}, {"White", m_playerSecondName}},
+               Board{},
+               m_history,
+               m_winner == PieceColor::First ? Pdn::FIRST_WINS : Pdn::SECOND_WINS);
+    if (!out)
+    {
+        std::cerr << "Warning: Unable to record the game to " << m_recordPath << ".\n";
+    }
+}
+
+bool Game::isComputerTurn() const
+{
+    if (m_gameOver || m_state != GameState::Playing)
+    {
+        return false;
+    }
+    return m_currentPlayer == PieceColor::First ? m_computerFirst : m_computerSecond;
+}
+
+void Game::startThinking()
+{
+    CHECKERS_PROFILE_SCOPE("startThinking");
+    // The last search has posted its move already; wait for its thread to
+    // finish so the mailbox never has two producers.
+    if (m_thinker.joinable())
+    {
+        m_thinker.join();
+    }
+    m_thinking = true;
+    m_thinkingProgress.reset();
+    updateStatusText();
+    m_dirty = true;
+    launchSearch(m_board, m_currentPlayer, false);
+}
+
+// Called when the computer has just moved and a person is to reply.
+void Game::startPondering()
+{
+    if (m_thinker.joinable())
+    {
+        m_thinker.join();
+    }
+    const std::optional<Board::Move> reply = m_engine.expectedMove(m_board);
+    if (!reply)
+    {
+        return;
+    }
+
+    Board expected = m_board;
+    expected.makeMove(*reply);
+    m_thinking = true;
+    m_pondering = true;
+    m_ponderMove = *reply;
+    m_ponderResult.reset();
+    m_thinkingProgress.reset();
+    launchSearch(expected, expected.sideToMove(), true);
+}
+
+void Game::launchSearch(const Board& board, PieceColor color, bool ponder)
+{
+    const std::uint64_t ticket = ++m_thinkTicket;
+    // Before the thread starts, so that a reply played at once still starts its clock.
+    if (ponder)
+    {
+        m_engine.preparePonder();
+    }
+    m_thinker = std::jthread([this, board, color, ponder, ticket](std::stop_token stop) {
+        const Engine::Progress progress = [this, ticket](const Engine::Result& iteration) {
+            // Progress is only shown, so it is dropped if the mailbox is full.
+            m_thinkMailbox.push(ThinkMessage{ticket, iteration, false});
+        };
+        const Engine::Result result = ponder ? m_engine.ponder(board, color, stop, progress)
+                                             : m_engine.search(board, color, stop, progress);
+        while (!m_thinkMailbox.push(ThinkMessage{ticket, result, true}) && !stop.stop_requested())
+        {
+            std::this_thread::yield();
+        }
+    });
+}
+
+void Game::collectThinking()
+{
+    // A ponder search that finished before its expected reply was played.
+    if (m_thinking && !m_pondering && m_ponderResult)
+    {
+        finishThinking(*m_ponderResult);
+    }
+
+    while (const std::optional<ThinkMessage> message = m_thinkMailbox.pop())
+    {
+        if (!m_thinking || message->ticket != m_thinkTicket)
+        {
+            continue;
+        }
+        if (!message->final)
+        {
+            // While pondering it is still the person's turn; show nothing yet.
+            m_thinkingProgress = message->result;
+            if (!m_pondering)
+            {
+                updateStatusText();
+                m_dirty = true;
+            }
+            continue;
+        }
+        if (m_pondering)
+        {
+            m_ponderResult = message->result;
+            continue;
+        }
+        finishThinking(message->result);
+    }
+}
+
+void Game::finishThinking(const Engine::Result& result)
+{
+    m_thinking = false;
+    m_thinkingProgress.reset();
+    m_ponderResult.reset();
+    if (result.bestMove)
+    {
+        playMove(*result.bestMove);
+        if (m_ponderEnabled && !m_gameOver && !isComputerTurn())
+        {
+            startPondering();
+        }
+    }
+}
+
+// Stops the search, if any, and waits for its thread; the engine looks for
+// the stop at every node, so this returns almost at once.
+void Game::cancelThinking()
+{
+    if (m_thinker.joinable())
+    {
+        m_thinker.request_stop();
+        m_thinker.join();
+    }
+    m_thinking = false;
+    m_thinkingProgress.reset();
+    m_pondering = false;
+    m_ponderResult.reset();
+    ++m_thinkTicket;
+}
+
+const Board::MoveList& Game::legalMoves()
+{
+    if (!m_legalMovesValid)
+    {
+        m_board.getLegalMoves(m_currentPlayer, m_legalMoves);
+        m_legalMovesValid = true;
+    }
+    return m_legalMoves;
+}
+
+Square Game::nextLanding(const Board::Move& move) const
+{
+    if (move.hopCount > m_chainStep)
+    {
+        return Board::squarePosition(move.landings[m_chainStep]);
+    }
+    return move.to;
+}
+
 void Game::switchTurn()
 {
     m_currentPlayer = (m_currentPlayer == PieceColor::First) ? PieceColor::Second : PieceColor::First;
@@ -426,66 +803,97 @@ void Game::updateStatusText()
     {
         text += " (piece selected)";
     }
+    else if (m_thinking && !m_pondering)
+    {
+        text += m_thinkingProgress && m_thinkingProgress->bestMove
+                  ? " (thinking: depth " + std::to_string(m_thinkingProgress->depth) + ", "
+                        + Notation::toString(*m_thinkingProgress->bestMove) + ")"
+                  : std::string(" (thinking)");
+    }
     m_turnText->setString(text);
 }
 
+void Game::setGameOverMessage(std::string message)
+{
+    m_gameOverMessage = std::move(message);
+    if (m_gameOverText)
+    {
+        m_gameOverText->setString(m_gameOverMessage);
+        const sf::FloatRect bounds = m_gameOverText->getLocalBounds();
+        m_gameOverText->setOrigin({bounds.size.x / 2.f, bounds.size.y / 2.f});
+    }
+    // The layer also holds the final position, which is only known now.
+    m_gameOverLayer.valid = false;
+}
+
+template <typename Paint>
+void Game::drawLayer(Layer& layer, Paint paint)
+{
+    if (!m_layersReady)
+    {
+        paint(m_window);
+        return;
+    }
+    if (!layer.valid)
+    {
+        layer.texture.clear(BACKGROUND);
+        paint(layer.texture);
+        layer.texture.display();
+        layer.valid = true;
+    }
+    m_window.draw(sf::Sprite(layer.texture.getTexture()));
+}
+
 void Game::render()
 {
-    m_window.clear(sf::Color(240, 235, 220));
-    
+    CHECKERS_PROFILE_SCOPE("render");
+    m_window.clear(BACKGROUND);
+
     if (m_state == GameState::StartScreen)
     {
-        sf::RectangleShape background(sf::Vector2f{static_cast<float>(WINDOW_SIZE), static_cast<float>(WINDOW_SIZE)});
-        background.setFillColor(sf::Color(240, 235, 220));
-        m_window.draw(background);
-        
-        if (m_fontLoaded && m_titleText)
-        {
-            m_window.draw(*m_titleText);
-        }
-        m_window.draw(m_startButton);
-        if (m_startButtonText)
-        {
-            auto pos = m_startButton.getPosition();
-            m_startButtonText->setPosition(pos);
-            m_window.draw(*m_startButtonText);
-        }
+        drawLayer(m_startLayer, [this](sf::RenderTarget& target) {
+            if (m_titleText)
+            {
+                target.draw(*m_titleText);
+            }
+            target.draw(m_startButton);
+            if (m_startButtonText)
+            {
+                target.draw(*m_startButtonText);
+            }
+        });
     }
     else if (m_state == GameState::NameInput)
     {
-        sf::RectangleShape background(sf::Vector2f{static_cast<float>(WINDOW_SIZE), static_cast<float>(WINDOW_SIZE)});
-        background.setFillColor(sf::Color(240, 235, 220));
-        m_window.draw(background);
-        
-        if (m_fontLoaded && m_nameInputLabel)
-        {
-            m_window.draw(*m_nameInputLabel);
-        }
-        
-        m_window.draw(m_nameInputBox);
-        
+        drawLayer(m_nameInputLayer, [this](sf::RenderTarget& target) {
+            if (m_nameInputLabel)
+            {
+                target.draw(*m_nameInputLabel);
+            }
+            target.draw(m_nameInputBox);
+            target.draw(m_nameInputButton);
+            if (m_nameInputButtonText)
+            {
+                target.draw(*m_nameInputButtonText);
+            }
+        });
+
+        // The one part that changes with each keystroke.
         if (m_nameInputText)
         {
             m_window.draw(*m_nameInputText);
         }
-        
-        m_window.draw(m_nameInputButton);
-        if (m_nameInputButtonText)
-        {
-            auto pos = m_nameInputButton.getPosition();
-            m_nameInputButtonText->setPosition(pos);
-            m_window.draw(*m_nameInputButtonText);
-        }
     }
     else if (m_state == GameState::Transitioning || m_state == GameState::Playing)
     {
-        m_board.draw(m_window, m_cellSize, m_selectedSquare, currentHighlightSquares());
+        const Board& shown = m_forcedCaptureChain ? m_chainBoard : m_board;
+        m_renderer.draw(m_window, shown, m_cellSize, m_selectedSquare, currentHighlightSquares());
 
         if (m_fontLoaded && m_turnText)
         {
             m_window.draw(*m_turnText);
         }
-        
+
         if (m_transitionAlpha > 0.f)
         {
             m_window.draw(m_transitionOverlay);
@@ -493,30 +901,33 @@ void Game::render()
     }
     else if (m_state == GameState::GameOver)
     {
-        m_board.draw(m_window, m_cellSize, std::nullopt, {});
-        
-        sf::RectangleShape overlay(sf::Vector2f{static_cast<float>(WINDOW_SIZE), static_cast<float>(WINDOW_SIZE)});
-        overlay.setFillColor(sf::Color(0, 0, 0, 180));
-        m_window.draw(overlay);
-        
-        if (m_fontLoaded)
-        {
-            sf::Text message(m_font, m_gameOverMessage, 36);
-            sf::FloatRect mb = message.getLocalBounds();
-            message.setOrigin({mb.size.x / 2.f, mb.size.y / 2.f});
-            message.setPosition({WINDOW_SIZE / 2.f, WINDOW_SIZE / 3.f});
-            message.setFillColor(sf::Color(245, 230, 200));
-            m_window.draw(message);
-        }
-        m_window.draw(m_rematchButton);
-        if (m_rematchButtonText)
-        {
-            auto pos = m_rematchButton.getPosition();
-            m_rematchButtonText->setPosition(pos);
-            m_window.draw(*m_rematchButtonText);
-        }
+        drawLayer(m_gameOverLayer, [this](sf::RenderTarget& target) {
+            m_renderer.draw(target, m_board, m_cellSize, std::nullopt, {});
+
+            sf::RectangleShape overlay(sf::Vector2f{static_cast<float>(WINDOW_SIZE), static_cast<float>(WINDOW_SIZE)});
+            overlay.setFillColor(sf::Color(0, 0, 0, 180));
+            target.draw(overlay);
+
+            if (m_gameOverText)
+            {
+                target.draw(*m_gameOverText);
+            }
+            target.draw(m_rematchButton);
+            if (m_rematchButtonText)
+            {
+                target.draw(*m_rematchButtonText);
+            }
+        });
+    }
+
+#ifdef CHECKERS_PROFILE
+    if (m_showProfiler)
+    {
+        m_profilerOverlay.draw(m_window, m_fontLoaded ? &m_font : nullptr, Profiler::instance().frameStats());
     }
+#endif
 
+    CHECKERS_PROFILE_SCOPE("display");
     m_window.display();
 }
 
@@ -525,25 +936,25 @@ void Game::checkForGameOver()
     if (m_board.countPieces(PieceColor::First) == 0)
     {
         m_gameOver = true;
-        m_gameOverMessage = m_playerSecondName + " wins!";
+        setGameOverMessage(m_playerSecondName + " wins!");
         m_winner = PieceColor::Second;
         m_state = GameState::GameOver;
     }
     else if (m_board.countPieces(PieceColor::Second) == 0)
     {
         m_gameOver = true;
-        m_gameOverMessage = m_playerFirstName + " wins!";
+        setGameOverMessage(m_playerFirstName + " wins!");
         m_winner = PieceColor::First;
         m_state = GameState::GameOver;
     }
 }
 
-std::vector<sf::Vector2i> Game::currentHighlightSquares() const
+std::vector<Square> Game::currentHighlightSquares() const
 {
-    std::vector<sf::Vector2i> highlights;
+    std::vector<Square> highlights;
     for (const auto& move : m_currentMoves)
     {
-        highlights.push_back(move.to);
+        highlights.push_back(nextLanding(move));
     }
     return highlights;
 }
@@ -1,12 +1,21 @@
 #pragma once
 
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <SFML/Graphics.hpp>
 
 #include "Board.h"
+#include "BoardRenderer.h"
+#include "Engine.h"
+#include "Mailbox.h"
+#include "OpeningBook.h"
+#include "Profiler.h"
+#include "ProfilerOverlay.h"
+#include "Tablebase.h"
 
 enum class GameState
 {
@@ -17,32 +26,120 @@ enum class GameState
     GameOver
 };
 
+struct GameOptions
+{
+    bool computerFirst = false;
+    bool computerSecond = false;
+    Engine::Limits engineLimits{64, 0, std::chrono::milliseconds(500)};
+    std::string tablebasePath; // empty for none
+    std::string bookPath;      // empty for none
+    std::string recordPath;    // finished games are appended here as PDN; empty for none
+    std::string tracePath;     // Chrome trace written on exit; needs CHECKERS_PROFILE
+    bool ponder = false;       // think on the opponent's time
+};
+
 class Game
 {
 public:
     Game();
+    explicit Game(const GameOptions& options);
     void run();
 
 private:
-    void processEvents();
+    // A full-window layer painted once into a texture and blitted every frame
+    // until something it shows changes.
+    struct Layer
+    {
+        sf::RenderTexture texture;
+        bool valid = false;
+    };
+
+    // What the thinking thread posts: its best move so far after each
+    // completed iteration, then the move to play.
+    struct ThinkMessage
+    {
+        std::uint64_t ticket;
+        Engine::Result result;
+        bool final;
+    };
+
+    template <typename Paint>
+    void drawLayer(Layer& layer, Paint paint);
+    void setGameOverMessage(std::string message);
+    bool isAnimating() const;
+    void processEvents(sf::Time wait);
+    void handleEvent(const sf::Event& event);
+    void updateHover(sf::RectangleShape& button, const sf::Vector2i& mousePos);
     void handleMouseClick(const sf::Vector2i& pixelPos);
     void handleTextInput(unsigned int unicode);
+    void playMove(const Board::Move& move);
+    bool isComputerTurn() const;
+    void startThinking();
+    void startPondering();
+    void launchSearch(const Board& board, PieceColor color, bool ponder);
+    void collectThinking();
+    void finishThinking(const Engine::Result& result);
+    void cancelThinking();
+    const Board::MoveList& legalMoves();
+    Square nextLanding(const Board::Move& move) const;
     void switchTurn();
     void updateStatusText();
     void render();
     void checkForGameOver();
-    std::vector<sf::Vector2i> currentHighlightSquares() const;
+    void recordGame();
+    std::vector<Square> currentHighlightSquares() const;
 
     sf::RenderWindow m_window;
     Board m_board;
+    BoardRenderer m_renderer;
     PieceColor m_currentPlayer;
     PieceColor m_winner{PieceColor::First};
     GameState m_state = GameState::StartScreen;
+    // Set when the scene has changed since the last frame was presented.
+    bool m_dirty = true;
+
+    // Legal moves for m_currentPlayer on m_board, generated on the first click
+    // after a move instead of on every click.
+    Board::MoveList m_legalMoves;
+    bool m_legalMovesValid = false;
 
-    std::optional<sf::Vector2i> m_selectedSquare;
-    std::vector<Board::Move> m_currentMoves;
+    std::optional<Square> m_selectedSquare;
+    Board::MoveList m_currentMoves;
     bool m_forcedCaptureChain = false;
-    sf::Vector2i m_chainPiece{-1, -1};
+    int m_chainStep = 0;
+    Square m_chainPiece{-1, -1};
+    Board m_chainBoard;
+
+    Tablebase m_tablebase;
+    OpeningBook m_book;
+    Engine m_engine;
+    bool m_computerFirst = false;
+    bool m_computerSecond = false;
+
+    // Computer moves are searched on m_thinker from a copy of the board and
+    // come back through the mailbox, so the frame loop never waits on the
+    // engine. Messages from a cancelled search carry an older ticket.
+    Mailbox<ThinkMessage, 64> m_thinkMailbox;
+    std::uint64_t m_thinkTicket = 0;
+    bool m_thinking = false;
+    std::optional<Engine::Result> m_thinkingProgress;
+
+    // After the computer moves, it may search the position after the reply
+    // it expects while the person thinks. A ponder search that ends before
+    // the reply is played keeps its result in m_ponderResult.
+    bool m_ponderEnabled = false;
+    bool m_pondering = false;
+    Board::Move m_ponderMove;
+    std::optional<Engine::Result> m_ponderResult;
+
+    std::string m_recordPath;
+    std::vector<Board::Move> m_history;
+
+#ifdef CHECKERS_PROFILE
+    std::string m_tracePath;
+    bool m_showProfiler = false;
+    ProfilerOverlay m_profilerOverlay;
+#endif
 
     sf::Font m_font;
     std::optional<sf::Text> m_turnText;
@@ -53,6 +150,14 @@ private:
 
     bool m_gameOver = false;
     std::string m_gameOverMessage;
+    std::optional<sf::Text> m_gameOverText;
+
+    // False if the layer textures could not be created; screens are then
+    // painted straight into the window.
+    bool m_layersReady = false;
+    Layer m_startLayer;
+    Layer m_nameInputLayer;
+    Layer m_gameOverLayer;
 
     sf::RectangleShape m_startButton;
     std::optional<sf::Text> m_startButtonText;
@@ -73,4 +178,7 @@ private:
     std::optional<sf::Text> m_nameInputText;
     sf::RectangleShape m_nameInputButton;
     std::optional<sf::Text> m_nameInputButtonText;
+
+    // Last, so it is stopped and joined before anything it uses is destroyed.
+    std::jthread m_thinker;
 };
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+// Vector-like container with inline storage for InlineCapacity elements.
+// Elements are not constructed until they are added, so an empty list costs
+// nothing to create on the stack. A list that outgrows its inline storage
+// moves to the heap rather than dropping elements.
+template <typename T, std::size_t InlineCapacity>
+class InlineList
+{
+    static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+                  "InlineList only holds trivially copyable types");
+
+public:
+    InlineList() = default;
+
+    InlineList(const InlineList& other)
+    {
+        copyFrom(other);
+    }
+
+    // Takes over the heap storage of a list that has moved there; inline
+    // elements are copied. The source is left empty.
+    InlineList(InlineList&& other) noexcept
+    {
+        moveFrom(other);
+    }
+
+    InlineList& operator=(const InlineList& other)
+    {
+        if (this != &other)
+        {
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    InlineList& operator=(InlineList&& other) noexcept
+    {
+        if (this != &other)
+        {
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    void push_back(const T& value)
+    {
+        if (m_end == m_limit) [[unlikely]]
+        {
+            grow();
+        }
+        new (m_end) T(value);
+        ++m_end;
+    }
+
+    void pop_back()
+    {
+        assert(!empty());
+        --m_end;
+    }
+
+    void truncate(std::size_t size)
+    {
+        assert(size <= this->size());
+        m_end = m_data + size;
+    }
+
+    void clear() { m_end = m_data; }
+
+    void reserve(std::size_t capacity)
+    {
+        if (capacity <= this->capacity())
+        {
+            return;
+        }
+        const std::size_t size = this->size();
+        auto heap = std::make_unique_for_overwrite<Storage[]>(capacity);
+        T* data = std::launder(reinterpret_cast<T*>(heap.get()));
+        std::memcpy(static_cast<void*>(data), m_data, sizeof(T) * size);
+        m_heap = std::move(heap);
+        m_data = data;
+        m_end = data + size;
+        m_limit = data + capacity;
+    }
+
+    std::size_t size() const { return static_cast<std::size_t>(m_end - m_data); }
+    bool empty() const { return m_end == m_data; }
+    std::size_t capacity() const { return static_cast<std::size_t>(m_limit - m_data); }
+    static constexpr std::size_t inlineCapacity() { return InlineCapacity; }
+
+    T& operator[](std::size_t index)
+    {
+        assert(index < size());
+        return m_data[index];
+    }
+
+    const T& operator[](std::size_t index) const
+    {
+        assert(index < size());
+        return m_data[index];
+    }
+
+    T& back() { return m_end[-1]; }
+    const T& back() const { return m_end[-1]; }
+
+    T* begin() { return m_data; }
+    T* end() { return m_end; }
+    const T* begin() const { return m_data; }
+    const T* end() const { return m_end; }
+
+private:
+    struct Storage
+    {
+        alignas(T) unsigned char bytes[sizeof(T)];
+    };
+
+    [[gnu::cold, gnu::noinline]] void grow()
+    {
+        reserve(capacity() * 2);
+    }
+
+    void copyFrom(const InlineList& other)
+    {
+        reserve(other.size());
+        std::memcpy(static_cast<void*>(m_data), other.m_data, sizeof(T) * other.size());
+        m_end = m_data + other.size();
+    }
+
+    void moveFrom(InlineList& other) noexcept
+    {
+        if (!other.m_heap)
+        {
+            // Fits in m_storage or in a heap block this list already has.
+            copyFrom(other);
+            other.clear();
+            return;
+        }
+        m_heap = std::move(other.m_heap);
+        m_data = other.m_data;
+        m_end = other.m_end;
+        m_limit = other.m_limit;
+        other.m_data = other.inlineData();
+        other.m_end = other.m_data;
+        other.m_limit = other.m_data + InlineCapacity;
+    }
+
+    T* inlineData() { return std::launder(reinterpret_cast<T*>(m_storage)); }
+
+    Storage m_storage[InlineCapacity];
+    std::unique_ptr<Storage[]> m_heap;
+    // Point into m_storage until the list outgrows it, then into m_heap.
+    T* m_data = inlineData();
+    T* m_end = m_data;
+    T* m_limit = m_data + InlineCapacity;
+};
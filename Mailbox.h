@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+
+// Lock-free queue from exactly one producer thread to exactly one consumer
+// thread, in a fixed ring of Capacity slots. Each side owns one index and only
+// reads the other's, so neither ever waits on the other: a full mailbox
+// refuses a message and an empty one returns nothing.
+template <typename T, std::size_t Capacity>
+class Mailbox
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Mailbox capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>, "Mailbox only holds trivially copyable types");
+
+public:
+    // Producer only. False if the mailbox is full.
+    bool push(const T& message)
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == Capacity)
+        {
+            return false;
+        }
+        m_slots[head % Capacity] = message;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only.
+    std::optional<T> pop()
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire))
+        {
+            return std::nullopt;
+        }
+        const T message = m_slots[tail % Capacity];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return message;
+    }
+
+private:
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    std::array<T, Capacity> m_slots{};
+    // On separate cache lines so the two threads do not share one.
+    alignas(CACHE_LINE) std::atomic<std::size_t> m_head{0};
+    alignas(CACHE_LINE) std::atomic<std::size_t> m_tail{0};
+};
@@ -0,0 +1,67 @@
+#include "MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::string& path, Access access)
+{
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat info{};
+    if (::fstat(fd, &info) != 0 || info.st_size <= 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    void* mapped = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping keeps the file alive on its own.
+    ::close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        return false;
+    }
+
+    // Lookups jump around the file, so read-ahead would only waste memory;
+    // a scan from start to end wants as much of it as the kernel will give.
+    ::madvise(mapped, static_cast<std::size_t>(info.st_size), access == Access::Random ? MADV_RANDOM : MADV_SEQUENTIAL);
+    m_data = static_cast<const std::uint8_t*>(mapped);
+    m_size = static_cast<std::size_t>(info.st_size);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data)
+    {
+        ::munmap(const_cast<std::uint8_t*>(m_data), m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+}
+
+bool MappedFile::isOpen() const
+{
+    return m_data != nullptr;
+}
+
+const std::uint8_t* MappedFile::data() const
+{
+    return m_data;
+}
+
+std::size_t MappedFile::size() const
+{
+    return m_size;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// A read-only memory mapping of a whole file. Pages are loaded by the OS on
+// first touch and shared with every other process mapping the same file.
+class MappedFile
+{
+public:
+    // How the mapping will be read, passed on to the kernel's read-ahead.
+    enum class Access
+    {
+        Random,
+        Sequential
+    };
+
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path, Access access = Access::Random);
+    void close();
+    bool isOpen() const;
+
+    const std::uint8_t* data() const;
+    std::size_t size() const;
+
+private:
+    const std::uint8_t* m_data = nullptr;
+    std::size_t m_size = 0;
+};
@@ -0,0 +1,341 @@
+#include "Notation.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+
+namespace
+{
+bool parseNumber(std::string_view text, int& value)
+{
+    const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+std::string_view trim(std::string_view text)
+{
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+    {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r'))
+    {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+// How a board's FEN names its players and numbers its squares. The 8x8 games
+// follow English PDN: B moves first and square 1 is in its back rank.
+// International PDN has White move first from 31-50, with square 1 in the
+// far corner of the second player's back rank.
+template <typename BoardType>
+struct FenConvention
+{
+    static constexpr char FIRST = 'B';
+    static constexpr char SECOND = 'W';
+
+    static int square(int number) { return BoardType::SQUARES - number; }
+    static int number(int square) { return BoardType::SQUARES - square; }
+};
+
+template <>
+struct FenConvention<InternationalBoard>
+{
+    static constexpr char FIRST = 'W';
+    static constexpr char SECOND = 'B';
+
+    static int square(int number) { return number - 1; }
+    static int number(int square) { return square + 1; }
+};
+
+// Parses the square list of one color: "W21,22,K30" or "B1-4" ranges.
+template <typename BoardType>
+bool parsePieceList(std::string_view list,
+                    typename BoardType::Bitboard& pieces,
+                    typename BoardType::Bitboard& kings)
+{
+    using Bitboard = typename BoardType::Bitboard;
+    while (!list.empty())
+    {
+        const std::size_t comma = list.find(',');
+        std::string_view item = trim(list.substr(0, comma));
+        list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+        if (item.empty())
+        {
+            continue;
+        }
+
+        const bool king = item.front() == 'K';
+        if (king)
+        {
+            item.remove_prefix(1);
+        }
+
+        int first = 0;
+        int last = 0;
+        const std::size_t dash = item.find('-');
+        if (dash == std::string_view::npos)
+        {
+            if (!parseNumber(item, first))
+            {
+                return false;
+            }
+            last = first;
+        }
+        else if (!parseNumber(item.substr(0, dash), first) || !parseNumber(item.substr(dash + 1), last))
+        {
+            return false;
+        }
+
+        for (int number = first; number <= last; ++number)
+        {
+            if (number < 1 || number > BoardType::SQUARES)
+            {
+                return false;
+            }
+            const Bitboard bit = Bitboard{1} << FenConvention<BoardType>::square(number);
+            pieces |= bit;
+            if (king)
+            {
+                kings |= bit;
+            }
+        }
+    }
+    return true;
+}
+
+bool isResultToken(std::string_view token)
+{
+    return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "2-0" || token == "0-2" || token == "1-1"
+        || token == "*";
+}
+
+void appendPieceList(std::string& out, Board::Bitboard pieces, Board::Bitboard kings)
+{
+    // Ascending square numbers, which is descending bit index.
+    bool first = true;
+    for (int number = 1; number <= Board::SQUARES; ++number)
+    {
+        const int square = Notation::squareFromNumber(number);
+        const Board::Bitboard bit = Board::Bitboard{1} << square;
+        if (!(pieces & bit))
+        {
+            continue;
+        }
+        if (!first)
+        {
+            out += ',';
+        }
+        first = false;
+        if (kings & bit)
+        {
+            out += 'K';
+        }
+        out += std::to_string(number);
+    }
+}
+}
+
+namespace Notation
+{
+int squareNumber(int square)
+{
+    return Board::SQUARES - square;
+}
+
+int squareFromNumber(int number)
+{
+    if (number < 1 || number > Board::SQUARES)
+    {
+        return -1;
+    }
+    return Board::SQUARES - number;
+}
+
+std::string toFen(const Board& board)
+{
+    std::string fen = board.sideToMove() == PieceColor::First ? "B" : "W";
+    fen += ":W";
+    appendPieceList(fen, board.piecesOf(PieceColor::Second), board.kings());
+    fen += ":B";
+    appendPieceList(fen, board.piecesOf(PieceColor::First), board.kings());
+    return fen;
+}
+
+std::optional<Board> parseFen(std::string_view fen)
+{
+    return parseFenAs<Board>(fen);
+}
+
+template <typename BoardType>
+int squareNumberAs(int square)
+{
+    return FenConvention<BoardType>::number(square);
+}
+
+template int squareNumberAs<Board>(int square);
+template int squareNumberAs<EnglishBoard>(int square);
+template int squareNumberAs<RussianBoard>(int square);
+template int squareNumberAs<InternationalBoard>(int square);
+
+template <typename BoardType>
+std::optional<BoardType> parseFenAs(std::string_view fen)
+{
+    using Convention = FenConvention<BoardType>;
+    fen = trim(fen);
+    if (fen.size() >= 2 && fen.front() == '"' && fen.back() == '"')
+    {
+        fen = fen.substr(1, fen.size() - 2);
+    }
+    if (fen.empty() || (fen.front() != 'B' && fen.front() != 'W'))
+    {
+        return std::nullopt;
+    }
+
+    const PieceColor toMove = fen.front() == Convention::FIRST ? PieceColor::First : PieceColor::Second;
+    typename BoardType::Bitboard first = 0;
+    typename BoardType::Bitboard second = 0;
+    typename BoardType::Bitboard kings = 0;
+
+    std::string_view rest = fen.substr(1);
+    while (!rest.empty())
+    {
+        if (rest.front() != ':' || rest.size() < 2)
+        {
+            return std::nullopt;
+        }
+        rest.remove_prefix(1);
+
+        const char side = rest.front();
+        rest.remove_prefix(1);
+        const std::size_t end = rest.find(':');
+        const std::string_view list = rest.substr(0, end);
+        rest = end == std::string_view::npos ? std::string_view{} : rest.substr(end);
+
+        auto& pieces = side == Convention::FIRST ? first : second;
+        if ((side != 'B' && side != 'W') || !parsePieceList<BoardType>(list, pieces, kings))
+        {
+            return std::nullopt;
+        }
+    }
+
+    if (first & second)
+    {
+        return std::nullopt;
+    }
+
+    BoardType board;
+    board.setPosition(first, second, kings, toMove);
+    return board;
+}
+
+template std::optional<Board> parseFenAs<Board>(std::string_view fen);
+template std::optional<EnglishBoard> parseFenAs<EnglishBoard>(std::string_view fen);
+template std::optional<RussianBoard> parseFenAs<RussianBoard>(std::string_view fen);
+template std::optional<InternationalBoard> parseFenAs<InternationalBoard>(std::string_view fen);
+
+std::string toString(const Board::Move& move)
+{
+    std::string text = std::to_string(squareNumber(Board::squareIndex(move.from)));
+    if (move.hopCount == 0)
+    {
+        text += '-';
+        text += std::to_string(squareNumber(Board::squareIndex(move.to)));
+        return text;
+    }
+
+    for (int hop = 0; hop < move.hopCount; ++hop)
+    {
+        text += 'x';
+        text += std::to_string(squareNumber(move.landings[hop]));
+    }
+    return text;
+}
+
+std::optional<Board::Move> parseMove(const Board& board, std::string_view text)
+{
+    text = trim(text);
+    const bool capture = text.find('x') != std::string_view::npos;
+    const char separator = capture ? 'x' : '-';
+
+    // Replaying large game files parses every move, so the squares stay on the stack.
+    std::array<int, Board::MAX_HOPS + 1> squares{};
+    std::size_t count = 0;
+    while (!text.empty())
+    {
+        const std::size_t next = text.find(separator);
+        int number = 0;
+        if (count == squares.size() || !parseNumber(text.substr(0, next), number) || squareFromNumber(number) < 0)
+        {
+            return std::nullopt;
+        }
+        squares[count++] = squareFromNumber(number);
+        text = next == std::string_view::npos ? std::string_view{} : text.substr(next + 1);
+    }
+    if (count < 2)
+    {
+        return std::nullopt;
+    }
+
+    Board::MoveList moves;
+    board.getLegalMoves(board.sideToMove(), moves);
+
+    // A capture written hop by hop names one sequence; "22x8" may also be
+    // shorthand for a longer one, but only if no single hop matches exactly.
+    std::optional<Board::Move> match;
+    std::optional<Board::Move> shorthand;
+    bool ambiguous = false;
+    for (const auto& move : moves)
+    {
+        if (Board::squareIndex(move.from) != squares.front() || Board::squareIndex(move.to) != squares[count - 1]
+            || move.isCapture != capture)
+        {
+            continue;
+        }
+
+        bool samePath = !capture || static_cast<std::size_t>(move.hopCount) == count - 1;
+        for (int hop = 0; samePath && capture && hop < move.hopCount; ++hop)
+        {
+            samePath = move.landings[hop] == squares[hop + 1];
+        }
+        if (samePath)
+        {
+            match = move;
+        }
+        else if (count == 2)
+        {
+            ambiguous = ambiguous || shorthand.has_value();
+            shorthand = move;
+        }
+    }
+    if (match || ambiguous)
+    {
+        return match;
+    }
+    return shorthand;
+}
+
+std::vector<std::string> splitMoves(std::string_view record)
+{
+    std::vector<std::string> moves;
+    while (!record.empty())
+    {
+        const std::size_t start = record.find_first_not_of(" \t\r\n");
+        if (start == std::string_view::npos)
+        {
+            break;
+        }
+        record.remove_prefix(start);
+        const std::size_t end = std::min(record.find_first_of(" \t\r\n"), record.size());
+        const std::string_view token = record.substr(0, end);
+        record.remove_prefix(end);
+
+        if (token.back() != '.' && !isResultToken(token))
+        {
+            moves.emplace_back(token);
+        }
+    }
+    return moves;
+}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Board.h"
+
+// Standard draughts notation. Squares are numbered 1..32 from the first
+// player's back rank, so the first player (who moves first, like Black in
+// English draughts) starts on 1-12. Positions use PDN FEN with B for the
+// first player and W for the second, e.g. "B:W21,22,K30:B1,2,3".
+namespace Notation
+{
+int squareNumber(int square);
+// Returns -1 when the number is not a square on the board.
+int squareFromNumber(int number);
+
+std::string toFen(const Board& board);
+std::optional<Board> parseFen(std::string_view fen);
+// The same for any board; instantiated for every board in Board.h. The 8x8
+// games are read as above. International positions are standard PDN: W moves
+// first, from squares 31-50, and square 1 is in the far corner of B's back rank.
+template <typename BoardType>
+std::optional<BoardType> parseFenAs(std::string_view fen);
+// The number of a square in BoardType's FEN and move texts.
+template <typename BoardType>
+int squareNumberAs(int square);
+
+// "11-15" for a quiet move, "22x15x8" listing every landing square for a capture.
+std::string toString(const Board::Move& move);
+// Accepts the forms written by toString, plus "22x8" as shorthand for a longer
+// capture when it is the only one from 22 to 8 and no single jump matches.
+// Only legal moves of the side to move match.
+std::optional<Board::Move> parseMove(const Board& board, std::string_view text);
+// The move texts of a game record such as "1. 11-15 23-19 2. 8-11 1-0", with
+// move numbers and the result dropped.
+std::vector<std::string> splitMoves(std::string_view record);
+}
@@ -0,0 +1,195 @@
+#include "OpeningBook.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "TranspositionTable.h"
+
+namespace
+{
+constexpr char MAGIC[8] = {'C', 'K', 'R', 'B', 'O', 'O', 'K', '1'};
+
+// On-disk layout, native byte order: the magic, the entry count, then one
+// 12-byte entry per (position, move) sorted by key and, within a key, by
+// descending weight.
+struct FileHeader
+{
+    char magic[8];
+    std::uint64_t entryCount;
+};
+
+constexpr std::size_t ENTRY_SIZE = sizeof(std::uint64_t) + 2 * sizeof(std::uint16_t);
+constexpr std::size_t MOVE_OFFSET = sizeof(std::uint64_t);
+constexpr std::size_t WEIGHT_OFFSET = MOVE_OFFSET + sizeof(std::uint16_t);
+constexpr std::uint64_t MAX_WEIGHT = UINT16_MAX;
+
+template <typename T>
+T readAt(const std::uint8_t* data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+}
+
+bool OpeningBook::open(const std::string& path)
+{
+    close();
+    if (!m_file.open(path) || m_file.size() < sizeof(FileHeader))
+    {
+        close();
+        return false;
+    }
+
+    FileHeader header{};
+    std::memcpy(&header, m_file.data(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0
+        || header.entryCount > (m_file.size() - sizeof(FileHeader)) / ENTRY_SIZE)
+    {
+        close();
+        return false;
+    }
+
+    m_entries = m_file.data() + sizeof(FileHeader);
+    m_size = static_cast<std::size_t>(header.entryCount);
+    return true;
+}
+
+void OpeningBook::close()
+{
+    m_file.close();
+    m_entries = nullptr;
+    m_size = 0;
+}
+
+bool OpeningBook::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+std::size_t OpeningBook::size() const
+{
+    return m_size;
+}
+
+std::vector<OpeningBook::Candidate> OpeningBook::candidates(const Board& board) const
+{
+    std::vector<Candidate> found;
+    if (m_size == 0)
+    {
+        return found;
+    }
+
+    // Lower bound on the key.
+    const std::uint64_t key = board.hash();
+    std::size_t low = 0;
+    std::size_t high = m_size;
+    while (low < high)
+    {
+        const std::size_t middle = low + (high - low) / 2;
+        if (keyAt(middle) < key)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    if (low == m_size || keyAt(low) != key)
+    {
+        return found;
+    }
+
+    // Entries store encoded moves; a hash collision or a stale book cannot
+    // produce anything but a legal move this way.
+    Board::MoveList moves;
+    board.getLegalMoves(board.sideToMove(), moves);
+    for (std::size_t i = low; i < m_size && keyAt(i) == key; ++i)
+    {
+        const std::uint8_t* entry = m_entries + i * ENTRY_SIZE;
+        const auto encoded = readAt<std::uint16_t>(entry + MOVE_OFFSET);
+        const auto weight = readAt<std::uint16_t>(entry + WEIGHT_OFFSET);
+        const auto legal = std::find_if(moves.begin(), moves.end(), [encoded](const Board::Move& move) {
+            return TranspositionTable::encodeMove(move) == encoded;
+        });
+        if (legal != moves.end() && weight > 0)
+        {
+            found.push_back(Candidate{*legal, weight});
+        }
+    }
+    return found;
+}
+
+std::optional<Board::Move> OpeningBook::pick(const Board& board, std::mt19937& random) const
+{
+    const auto found = candidates(board);
+    if (found.empty())
+    {
+        return std::nullopt;
+    }
+
+    int total = 0;
+    for (const auto& candidate : found)
+    {
+        total += candidate.weight;
+    }
+    int roll = std::uniform_int_distribution<int>(0, total - 1)(random);
+    for (const auto& candidate : found)
+    {
+        roll -= candidate.weight;
+        if (roll < 0)
+        {
+            return candidate.move;
+        }
+    }
+    return found.back().move;
+}
+
+std::uint64_t OpeningBook::keyAt(std::size_t index) const
+{
+    return readAt<std::uint64_t>(m_entries + index * ENTRY_SIZE);
+}
+
+void OpeningBookBuilder::add(const Board& board, const Board::Move& move, int weight)
+{
+    m_moves[board.hash()][TranspositionTable::encodeMove(move)] += static_cast<std::uint64_t>(std::max(weight, 0));
+}
+
+std::size_t OpeningBookBuilder::positions() const
+{
+    return m_moves.size();
+}
+
+bool OpeningBookBuilder::write(const std::string& path) const
+{
+    std::vector<std::uint8_t> entries;
+    for (const auto& [key, moves] : m_moves)
+    {
+        std::vector<std::pair<std::uint16_t, std::uint16_t>> sorted;
+        for (const auto& [move, weight] : moves)
+        {
+            sorted.emplace_back(move, static_cast<std::uint16_t>(std::min(weight, MAX_WEIGHT)));
+        }
+        std::stable_sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+
+        for (const auto& [move, weight] : sorted)
+        {
+            std::uint8_t entry[ENTRY_SIZE];
+            std::memcpy(entry, &key, sizeof(key));
+            std::memcpy(entry + MOVE_OFFSET, &move, sizeof(move));
+            std::memcpy(entry + WEIGHT_OFFSET, &weight, sizeof(weight));
+            entries.insert(entries.end(), entry, entry + ENTRY_SIZE);
+        }
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.entryCount = entries.size() / ENTRY_SIZE;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size()));
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Board.h"
+#include "MappedFile.h"
+
+// Opening moves keyed by position hash. The file is a header followed by
+// fixed-size entries sorted by key, so a lookup is a binary search straight
+// over the mapping and opening the book reads nothing up front.
+class OpeningBook
+{
+public:
+    struct Candidate
+    {
+        Board::Move move;
+        int weight = 0;
+    };
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+    std::size_t size() const;
+
+    // Book moves that are legal in the position, heaviest first.
+    std::vector<Candidate> candidates(const Board& board) const;
+    // A book move chosen with probability proportional to its weight.
+    std::optional<Board::Move> pick(const Board& board, std::mt19937& random) const;
+
+private:
+    std::uint64_t keyAt(std::size_t index) const;
+
+    MappedFile m_file;
+    const std::uint8_t* m_entries = nullptr;
+    std::size_t m_size = 0;
+};
+
+// Collects (position, move) pairs from games and writes them as a book. A move
+// seen several times in the same position gets a proportionally larger weight.
+class OpeningBookBuilder
+{
+public:
+    void add(const Board& board, const Board::Move& move, int weight = 1);
+    std::size_t positions() const;
+    bool write(const std::string& path) const;
+
+private:
+    // key -> encoded move -> weight
+    std::map<std::uint64_t, std::map<std::uint16_t, std::uint64_t>> m_moves;
+};
@@ -0,0 +1,329 @@
+#include "Pdn.h"
+
+namespace
+{
+constexpr std::size_t LINE_WIDTH = 80;
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Characters that end a move token without whitespace before them.
+bool endsToken(char c)
+{
+    return isSpace(c) || c == '{' || c == '(' || c == '[' || c == ';';
+}
+
+bool isResultToken(std::string_view token)
+{
+    return token == Pdn::FIRST_WINS || token == Pdn::SECOND_WINS || token == Pdn::DRAW || token == Pdn::UNFINISHED
+        || token == "1-0" || token == "0-1" || token == "1/2-1/2";
+}
+
+// Drops a leading move number ("12." or "12...") and trailing annotation
+// marks ("!", "?"); what is left is a move, or empty for a bare number.
+std::string_view moveText(std::string_view token)
+{
+    std::size_t digits = 0;
+    while (digits < token.size() && isDigit(token[digits]))
+    {
+        ++digits;
+    }
+    if (digits > 0 && digits < token.size() && token[digits] == '.')
+    {
+        token.remove_prefix(digits);
+        while (!token.empty() && token.front() == '.')
+        {
+            token.remove_prefix(1);
+        }
+    }
+    while (!token.empty() && (token.back() == '!' || token.back() == '?'))
+    {
+        token.remove_suffix(1);
+    }
+    return token;
+}
+
+void writeEscaped(std::ostream& out, std::string_view value)
+{
+    for (const char c : value)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out << '\\';
+        }
+        out << c;
+    }
+}
+}
+
+namespace Pdn
+{
+std::string_view GameRecord::tag(std::string_view name) const
+{
+    for (const Tag& tag : tags)
+    {
+        if (tag.name == name)
+        {
+            return tag.value;
+        }
+    }
+    return {};
+}
+
+void write(std::ostream& out,
+           const std::vector<TagPair>& tags,
+           const Board& start,
+           const std::vector<Board::Move>& moves,
+           std::string_view result)
+{
+    for (const TagPair& tag : tags)
+    {
+        out << '[' << tag.name << " \"";
+        writeEscaped(out, tag.value);
+        out << "\"]\n";
+    }
+    out << "[Result \"" << result << "\"]\n";
+    if (start.hash() != Board{}.hash())
+    {
+        out << "[SetUp \"1\"]\n[FEN \"" << Notation::toFen(start) << "\"]\n";
+    }
+
+    std::size_t column = 0;
+    const auto emit = [&](const std::string& token) {
+        if (column > 0 && column + 1 + token.size() > LINE_WIDTH)
+        {
+            out << '\n';
+            column = 0;
+        }
+        else if (column > 0)
+        {
+            out << ' ';
+            ++column;
+        }
+        out << token;
+        column += token.size();
+    };
+
+    // Move numbers count pairs of plies and stay on the line of the move they
+    // number; a game starting with the second player to move opens with "1...".
+    int ply = start.sideToMove() == PieceColor::First ? 0 : 1;
+    for (const Board::Move& move : moves)
+    {
+        std::string token = Notation::toString(move);
+        if (ply % 2 == 0)
+        {
+            token = std::to_string(ply / 2 + 1) + ". " + token;
+        }
+        else if (&move == &moves.front())
+        {
+            token = std::to_string(ply / 2 + 1) + "... " + token;
+        }
+        emit(token);
+        ++ply;
+    }
+    emit(std::string(result));
+    out << "\n\n";
+}
+
+std::optional<Board> startPosition(const GameRecord& game)
+{
+    const std::string_view fen = game.tag("FEN");
+    if (fen.empty())
+    {
+        return Board{};
+    }
+    return Notation::parseFen(fen);
+}
+
+bool Reader::open(const std::string& path)
+{
+    close();
+    if (!m_file.open(path, MappedFile::Access::Sequential))
+    {
+        return false;
+    }
+    m_text = std::string_view(reinterpret_cast<const char*>(m_file.data()), m_file.size());
+    return true;
+}
+
+void Reader::attach(std::string_view text)
+{
+    close();
+    m_text = text;
+}
+
+void Reader::close()
+{
+    m_file.close();
+    m_text = {};
+    m_position = 0;
+}
+
+bool Reader::isOpen() const
+{
+    return m_text.data() != nullptr;
+}
+
+std::size_t Reader::size() const
+{
+    return m_text.size();
+}
+
+bool Reader::next(GameRecord& game)
+{
+    game.tags.clear();
+    game.moves.clear();
+    game.result = {};
+
+    skipSeparators();
+    if (m_position >= m_text.size())
+    {
+        return false;
+    }
+    game.offset = m_position;
+
+    while (m_position < m_text.size() && m_text[m_position] == '[')
+    {
+        if (!readTag(game))
+        {
+            break;
+        }
+        skipSeparators();
+    }
+
+    // Movetext runs to a result, or to the next game's tags when the result
+    // is missing.
+    while (true)
+    {
+        skipSeparators();
+        if (m_position >= m_text.size() || m_text[m_position] == '[')
+        {
+            break;
+        }
+
+        const std::size_t start = m_position;
+        while (m_position < m_text.size() && !endsToken(m_text[m_position]))
+        {
+            ++m_position;
+        }
+        const std::string_view token = m_text.substr(start, m_position - start);
+        if (isResultToken(token))
+        {
+            game.result = token;
+            break;
+        }
+        if (token.front() == '$')
+        {
+            continue; // numeric annotation glyph
+        }
+        const std::string_view move = moveText(token);
+        if (!move.empty())
+        {
+            game.moves.push_back(move);
+        }
+    }
+
+    game.text = m_text.substr(game.offset, m_position - game.offset);
+    return true;
+}
+
+bool Reader::seek(std::uint64_t offset)
+{
+    if (offset > m_text.size())
+    {
+        return false;
+    }
+    m_position = static_cast<std::size_t>(offset);
+    return true;
+}
+
+std::uint64_t Reader::position() const
+{
+    return m_position;
+}
+
+// Whitespace, comments and variations: nothing that belongs to the game line.
+void Reader::skipSeparators()
+{
+    while (m_position < m_text.size())
+    {
+        const char c = m_text[m_position];
+        if (isSpace(c))
+        {
+            ++m_position;
+        }
+        else if (c == '{')
+        {
+            skipUntil('}');
+        }
+        else if (c == ';')
+        {
+            skipUntil('\n');
+        }
+        else if (c == '(')
+        {
+            // Variations nest and may hold comments with parentheses in them.
+            int depth = 0;
+            while (m_position < m_text.size())
+            {
+                const char inner = m_text[m_position];
+                if (inner == '{')
+                {
+                    skipUntil('}');
+                    continue;
+                }
+                ++m_position;
+                depth += inner == '(' ? 1 : inner == ')' ? -1 : 0;
+                if (depth == 0)
+                {
+                    break;
+                }
+            }
+        }
+        else
+        {
+            return;
+        }
+    }
+}
+
+// Moves past the next `close` character, or to the end of the text.
+void Reader::skipUntil(char close)
+{
+    const std::size_t end = m_text.find(close, m_position + 1);
+    m_position = end == std::string_view::npos ? m_text.size() : end + 1;
+}
+
+bool Reader::readTag(GameRecord& game)
+{
+    const std::size_t end = m_text.find(']', m_position);
+    if (end == std::string_view::npos)
+    {
+        m_position = m_text.size();
+        return false;
+    }
+    std::string_view body = m_text.substr(m_position + 1, end - m_position - 1);
+    m_position = end + 1;
+
+    const std::size_t firstQuote = body.find('"');
+    const std::size_t lastQuote = body.rfind('"');
+    if (firstQuote == std::string_view::npos || lastQuote == firstQuote)
+    {
+        return true; // malformed; skipped
+    }
+    std::string_view name = body.substr(0, firstQuote);
+    while (!name.empty() && isSpace(name.back()))
+    {
+        name.remove_suffix(1);
+    }
+    game.tags.push_back(Tag{name, body.substr(firstQuote + 1, lastQuote - firstQuote - 1)});
+    return true;
+}
+}
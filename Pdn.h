@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Board.h"
+#include "MappedFile.h"
+#include "Notation.h"
+
+// Portable Draughts Notation game records: tag pairs such as [Event "Club"]
+// followed by numbered moves and a result. The first player is Black, as in
+// Notation's FEN, and results read first player first: "2-0" is a win for the
+// first player, "0-2" for the second and "1-1" a draw.
+namespace Pdn
+{
+constexpr std::string_view FIRST_WINS = "2-0";
+constexpr std::string_view SECOND_WINS = "0-2";
+constexpr std::string_view DRAW = "1-1";
+constexpr std::string_view UNFINISHED = "*";
+
+struct Tag
+{
+    std::string_view name;
+    // As written between the quotes, so escaped characters stay escaped.
+    std::string_view value;
+};
+
+// One game as found in the text. Every view points into the text being read
+// and stays valid while it does; the vectors are reused from game to game.
+struct GameRecord
+{
+    std::uint64_t offset = 0; // of the game's first character
+    std::string_view text;
+    std::vector<Tag> tags;
+    std::vector<std::string_view> moves;
+    std::string_view result;
+
+    // Empty when the tag is absent.
+    std::string_view tag(std::string_view name) const;
+};
+
+struct TagPair
+{
+    std::string name;
+    std::string value;
+};
+
+// Writes one game. Result and, when the game does not start from the standard
+// position, SetUp and FEN tags are added to the ones given.
+void write(std::ostream& out,
+           const std::vector<TagPair>& tags,
+           const Board& start,
+           const std::vector<Board::Move>& moves,
+           std::string_view result);
+
+// The FEN tag's position, or the standard start when there is none.
+std::optional<Board> startPosition(const GameRecord& game);
+
+// Calls visit(board) for the start position and after each move. Returns
+// false if the start position or a move cannot be read; the positions up to
+// that point have been visited.
+template <typename Visit>
+bool replay(const GameRecord& game, Visit&& visit)
+{
+    std::optional<Board> board = startPosition(game);
+    if (!board)
+    {
+        return false;
+    }
+    visit(static_cast<const Board&>(*board));
+    for (const std::string_view text : game.moves)
+    {
+        const std::optional<Board::Move> move = Notation::parseMove(*board, text);
+        if (!move)
+        {
+            return false;
+        }
+        board->makeMove(*move);
+        visit(static_cast<const Board&>(*board));
+    }
+    return true;
+}
+
+// Reads games one at a time from a memory-mapped file, or from text the caller
+// keeps alive. Nothing is copied: a file of any size is parsed in place, and
+// only the pages being read need to be resident.
+class Reader
+{
+public:
+    bool open(const std::string& path);
+    void attach(std::string_view text);
+    void close();
+    bool isOpen() const;
+    std::size_t size() const;
+
+    // False once no game is left.
+    bool next(GameRecord& game);
+    // Continues reading at a game's offset, as recorded by a position index.
+    bool seek(std::uint64_t offset);
+    std::uint64_t position() const;
+
+private:
+    void skipSeparators();
+    void skipUntil(char close);
+    bool readTag(GameRecord& game);
+
+    MappedFile m_file;
+    std::string_view m_text;
+    std::size_t m_position = 0;
+};
+}
@@ -0,0 +1,73 @@
+#include "Player.h"
+
+#include "Notation.h"
+
+RandomPlayer::RandomPlayer(std::uint32_t seed)
+    : m_seed(seed)
+    , m_random(seed)
+{
+}
+
+std::string RandomPlayer::name() const
+{
+    return "random";
+}
+
+void RandomPlayer::newGame(std::uint64_t game)
+{
+    std::seed_seq sequence{m_seed, static_cast<std::uint32_t>(game), static_cast<std::uint32_t>(game >> 32)};
+    m_random.seed(sequence);
+}
+
+Board::Move RandomPlayer::chooseMove(const Board&, const Board::MoveList& moves, int)
+{
+    return moves[std::uniform_int_distribution<std::size_t>(0, moves.size() - 1)(m_random)];
+}
+
+EnginePlayer::EnginePlayer(const Engine::Limits& limits, std::size_t tableMegabytes)
+    : m_engine(limits, tableMegabytes)
+{
+}
+
+Engine& EnginePlayer::engine()
+{
+    return m_engine;
+}
+
+std::string EnginePlayer::name() const
+{
+    return "engine";
+}
+
+Board::Move EnginePlayer::chooseMove(const Board& board, const Board::MoveList& moves, int)
+{
+    const Engine::Result result = m_engine.search(board, board.sideToMove());
+    return result.bestMove ? *result.bestMove : moves[0];
+}
+
+ScriptedPlayer::ScriptedPlayer(const std::vector<std::vector<std::string>>& lines)
+    : m_lines(lines)
+{
+}
+
+std::string ScriptedPlayer::name() const
+{
+    return "scripted";
+}
+
+void ScriptedPlayer::newGame(std::uint64_t game)
+{
+    m_line = m_lines.empty() ? 0 : static_cast<std::size_t>(game % m_lines.size());
+}
+
+Board::Move ScriptedPlayer::chooseMove(const Board& board, const Board::MoveList& moves, int ply)
+{
+    if (m_line < m_lines.size() && static_cast<std::size_t>(ply) < m_lines[m_line].size())
+    {
+        if (const auto move = Notation::parseMove(board, m_lines[m_line][ply]))
+        {
+            return *move;
+        }
+    }
+    return moves[0];
+}
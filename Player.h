@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Board.h"
+#include "Engine.h"
+
+// Something that picks moves for one side, used by the headless runner.
+// Players keep per-game state, so one instance plays one game at a time.
+class Player
+{
+public:
+    virtual ~Player() = default;
+
+    virtual std::string name() const = 0;
+    virtual void newGame(std::uint64_t /*game*/) {}
+    // `moves` holds the legal moves of the side to move and is never empty;
+    // `ply` counts the moves already played in the game.
+    virtual Board::Move chooseMove(const Board& board, const Board::MoveList& moves, int ply) = 0;
+};
+
+// Uniformly random legal moves, reproducible per game from the seed.
+class RandomPlayer : public Player
+{
+public:
+    explicit RandomPlayer(std::uint32_t seed);
+
+    std::string name() const override;
+    void newGame(std::uint64_t game) override;
+    Board::Move chooseMove(const Board& board, const Board::MoveList& moves, int ply) override;
+
+private:
+    std::uint32_t m_seed;
+    std::mt19937 m_random;
+};
+
+class EnginePlayer : public Player
+{
+public:
+    EnginePlayer(const Engine::Limits& limits, std::size_t tableMegabytes);
+
+    Engine& engine();
+    std::string name() const override;
+    Board::Move chooseMove(const Board& board, const Board::MoveList& moves, int ply) override;
+
+private:
+    Engine m_engine;
+};
+
+// Replays recorded games: game n follows line n (wrapping around) of the
+// script, one move per ply in standard notation for both sides. Once the line
+// runs out or its move is not legal here, the first legal move is played.
+class ScriptedPlayer : public Player
+{
+public:
+    explicit ScriptedPlayer(const std::vector<std::vector<std::string>>& lines);
+
+    std::string name() const override;
+    void newGame(std::uint64_t game) override;
+    Board::Move chooseMove(const Board& board, const Board::MoveList& moves, int ply) override;
+
+private:
+    const std::vector<std::vector<std::string>>& m_lines;
+    std::size_t m_line = 0;
+};
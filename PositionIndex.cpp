@@ -0,0 +1,300 @@
+#include "PositionIndex.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <queue>
+
+namespace
+{
+constexpr char MAGIC[8] = {'C', 'K', 'R', 'P', 'I', 'D', 'X', '1'};
+
+// On-disk layout, native byte order: the header, then one 16-byte entry per
+// distinct (position, game) pair sorted by key and then offset.
+struct FileHeader
+{
+    char magic[8];
+    std::uint64_t entryCount;
+    std::uint64_t sourceSize;
+};
+
+constexpr std::size_t ENTRY_SIZE = PositionIndexBuilder::ENTRY_BYTES;
+// Entries read at a time from each run while merging.
+constexpr std::size_t MERGE_BLOCK = 4096;
+
+template <typename T>
+T readAt(const std::uint8_t* data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+// Buffered sequential reader over one sorted run.
+class RunReader
+{
+public:
+    explicit RunReader(const std::string& path)
+        : m_in(path, std::ios::binary)
+    {
+    }
+
+    bool good() const
+    {
+        return static_cast<bool>(m_in) || m_next < m_count;
+    }
+
+    // False once the run is exhausted.
+    bool next(std::uint64_t& key, std::uint64_t& offset)
+    {
+        if (m_next == m_count)
+        {
+            m_in.read(reinterpret_cast<char*>(m_block.data()), static_cast<std::streamsize>(m_block.size()));
+            m_count = static_cast<std::size_t>(m_in.gcount()) / ENTRY_SIZE;
+            m_next = 0;
+            if (m_count == 0)
+            {
+                return false;
+            }
+        }
+        const std::uint8_t* entry = m_block.data() + m_next * ENTRY_SIZE;
+        key = readAt<std::uint64_t>(entry);
+        offset = readAt<std::uint64_t>(entry + sizeof(std::uint64_t));
+        ++m_next;
+        return true;
+    }
+
+private:
+    std::ifstream m_in;
+    std::vector<std::uint8_t> m_block = std::vector<std::uint8_t>(MERGE_BLOCK * ENTRY_SIZE);
+    std::size_t m_count = 0;
+    std::size_t m_next = 0;
+};
+}
+
+bool PositionIndex::open(const std::string& path)
+{
+    close();
+    if (!m_file.open(path) || m_file.size() < sizeof(FileHeader))
+    {
+        close();
+        return false;
+    }
+
+    FileHeader header{};
+    std::memcpy(&header, m_file.data(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0
+        || header.entryCount > (m_file.size() - sizeof(FileHeader)) / ENTRY_SIZE)
+    {
+        close();
+        return false;
+    }
+
+    m_entries = m_file.data() + sizeof(FileHeader);
+    m_size = static_cast<std::size_t>(header.entryCount);
+    m_sourceSize = header.sourceSize;
+    return true;
+}
+
+void PositionIndex::close()
+{
+    m_file.close();
+    m_entries = nullptr;
+    m_size = 0;
+    m_sourceSize = 0;
+}
+
+bool PositionIndex::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+std::size_t PositionIndex::size() const
+{
+    return m_size;
+}
+
+std::uint64_t PositionIndex::sourceSize() const
+{
+    return m_sourceSize;
+}
+
+std::vector<std::uint64_t> PositionIndex::find(std::uint64_t key) const
+{
+    // Lower bound on the key.
+    std::size_t low = 0;
+    std::size_t high = m_size;
+    while (low < high)
+    {
+        const std::size_t middle = low + (high - low) / 2;
+        if (keyAt(middle) < key)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    std::vector<std::uint64_t> offsets;
+    for (std::size_t i = low; i < m_size && keyAt(i) == key; ++i)
+    {
+        offsets.push_back(offsetAt(i));
+    }
+    return offsets;
+}
+
+std::vector<std::uint64_t> PositionIndex::find(const Board& board) const
+{
+    return find(board.hash());
+}
+
+std::uint64_t PositionIndex::keyAt(std::size_t index) const
+{
+    return readAt<std::uint64_t>(m_entries + index * ENTRY_SIZE);
+}
+
+std::uint64_t PositionIndex::offsetAt(std::size_t index) const
+{
+    return readAt<std::uint64_t>(m_entries + index * ENTRY_SIZE + sizeof(std::uint64_t));
+}
+
+PositionIndexBuilder::PositionIndexBuilder(std::string path, std::size_t runEntries)
+    : m_path(std::move(path))
+    , m_runEntries(std::max<std::size_t>(runEntries, 1))
+{
+}
+
+PositionIndexBuilder::~PositionIndexBuilder()
+{
+    removeRuns();
+}
+
+bool PositionIndexBuilder::add(std::uint64_t key, std::uint64_t offset)
+{
+    m_buffer.push_back(Entry{key, offset});
+    ++m_added;
+    return m_buffer.size() < m_runEntries || spill();
+}
+
+std::uint64_t PositionIndexBuilder::added() const
+{
+    return m_added;
+}
+
+std::optional<std::uint64_t> PositionIndexBuilder::write(std::uint64_t sourceSize)
+{
+    if (m_runs > 0 && !m_buffer.empty() && !spill())
+    {
+        return std::nullopt;
+    }
+
+    std::ofstream out(m_path, std::ios::binary | std::ios::trunc);
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.sourceSize = sourceSize;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::uint64_t written = 0;
+    bool any = false;
+    Entry last{};
+    const auto emit = [&](const Entry& entry) {
+        // A position repeated within one game is listed for it once.
+        if (any && entry.key == last.key && entry.offset == last.offset)
+        {
+            return;
+        }
+        out.write(reinterpret_cast<const char*>(&entry.key), sizeof(entry.key));
+        out.write(reinterpret_cast<const char*>(&entry.offset), sizeof(entry.offset));
+        last = entry;
+        any = true;
+        ++written;
+    };
+    const auto before = [](const Entry& a, const Entry& b) {
+        return a.key != b.key ? a.key < b.key : a.offset < b.offset;
+    };
+
+    if (m_runs == 0)
+    {
+        std::sort(m_buffer.begin(), m_buffer.end(), before);
+        for (const Entry& entry : m_buffer)
+        {
+            emit(entry);
+        }
+    }
+    else
+    {
+        // k-way merge of the sorted runs.
+        std::vector<std::unique_ptr<RunReader>> readers;
+        using Head = std::pair<Entry, std::size_t>;
+        const auto later = [&before](const Head& a, const Head& b) { return before(b.first, a.first); };
+        std::priority_queue<Head, std::vector<Head>, decltype(later)> heads(later);
+        for (std::size_t run = 0; run < m_runs; ++run)
+        {
+            readers.push_back(std::make_unique<RunReader>(runPath(run)));
+            Entry entry{};
+            if (!readers.back()->good())
+            {
+                return std::nullopt;
+            }
+            if (readers.back()->next(entry.key, entry.offset))
+            {
+                heads.emplace(entry, run);
+            }
+        }
+        while (!heads.empty())
+        {
+            auto [entry, run] = heads.top();
+            heads.pop();
+            emit(entry);
+            if (readers[run]->next(entry.key, entry.offset))
+            {
+                heads.emplace(entry, run);
+            }
+        }
+    }
+
+    header.entryCount = written;
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    removeRuns();
+    m_buffer.clear();
+    if (!out)
+    {
+        return std::nullopt;
+    }
+    return written;
+}
+
+bool PositionIndexBuilder::spill()
+{
+    std::sort(m_buffer.begin(), m_buffer.end(), [](const Entry& a, const Entry& b) {
+        return a.key != b.key ? a.key < b.key : a.offset < b.offset;
+    });
+    std::ofstream out(runPath(m_runs), std::ios::binary | std::ios::trunc);
+    for (const Entry& entry : m_buffer)
+    {
+        out.write(reinterpret_cast<const char*>(&entry.key), sizeof(entry.key));
+        out.write(reinterpret_cast<const char*>(&entry.offset), sizeof(entry.offset));
+    }
+    ++m_runs;
+    m_buffer.clear();
+    return static_cast<bool>(out);
+}
+
+std::string PositionIndexBuilder::runPath(std::size_t run) const
+{
+    return m_path + ".run" + std::to_string(run);
+}
+
+void PositionIndexBuilder::removeRuns()
+{
+    for (std::size_t run = 0; run < m_runs; ++run)
+    {
+        std::remove(runPath(run).c_str());
+    }
+    m_runs = 0;
+}
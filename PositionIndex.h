@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Board.h"
+#include "MappedFile.h"
+
+// Which games of a PDN file reach each position. The file is a header followed
+// by (position hash, game offset) entries sorted by hash then offset, so, like
+// the opening book, a lookup is a binary search straight over the mapping.
+class PositionIndex
+{
+public:
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+    std::size_t size() const;
+    // Size of the PDN file the index was built from, to spot a stale index.
+    std::uint64_t sourceSize() const;
+
+    // Offsets of the games reaching the position, ascending. A hash collision
+    // can add a game that does not; replay it to be sure.
+    std::vector<std::uint64_t> find(std::uint64_t key) const;
+    std::vector<std::uint64_t> find(const Board& board) const;
+
+private:
+    std::uint64_t keyAt(std::size_t index) const;
+    std::uint64_t offsetAt(std::size_t index) const;
+
+    MappedFile m_file;
+    const std::uint8_t* m_entries = nullptr;
+    std::size_t m_size = 0;
+    std::uint64_t m_sourceSize = 0;
+};
+
+// Collects (position, game) pairs and writes them as an index. Archives can
+// hold far more positions than fit in memory, so entries are sorted in runs
+// of at most `runEntries`, spilled to temporary files next to the output and
+// merged when the index is written.
+class PositionIndexBuilder
+{
+public:
+    // Memory one buffered entry takes.
+    static constexpr std::size_t ENTRY_BYTES = 2 * sizeof(std::uint64_t);
+    static constexpr std::size_t DEFAULT_RUN_ENTRIES = std::size_t{1} << 24; // 256 MB
+
+    explicit PositionIndexBuilder(std::string path, std::size_t runEntries = DEFAULT_RUN_ENTRIES);
+    ~PositionIndexBuilder();
+    PositionIndexBuilder(const PositionIndexBuilder&) = delete;
+    PositionIndexBuilder& operator=(const PositionIndexBuilder&) = delete;
+
+    bool add(std::uint64_t key, std::uint64_t offset);
+    std::uint64_t added() const;
+    // Writes the index for a source file of the given size; returns the
+    // number of distinct entries written, or nothing on an I/O error.
+    std::optional<std::uint64_t> write(std::uint64_t sourceSize);
+
+private:
+    struct Entry
+    {
+        std::uint64_t key;
+        std::uint64_t offset;
+    };
+
+    bool spill();
+    std::string runPath(std::size_t run) const;
+    void removeRuns();
+
+    std::string m_path;
+    std::size_t m_runEntries;
+    std::vector<Entry> m_buffer;
+    std::size_t m_runs = 0;
+    std::uint64_t m_added = 0;
+};
@@ -0,0 +1,111 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+
+namespace
+{
+// Small, stable thread numbers read better in a trace viewer than hashes.
+std::uint32_t threadNumber()
+{
+    static std::atomic<std::uint32_t> next{1};
+    thread_local const std::uint32_t number = next.fetch_add(1, std::memory_order_relaxed);
+    return number;
+}
+
+double percentile(const std::vector<float>& sorted, double fraction)
+{
+    const auto index = static_cast<std::size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+}
+
+Profiler& Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+void Profiler::beginFrame()
+{
+    m_frameStart = Clock::now();
+}
+
+void Profiler::endFrame()
+{
+    const Clock::time_point end = Clock::now();
+    const float milliseconds = std::chrono::duration<float, std::milli>(end - m_frameStart).count();
+    record("frame", m_frameStart, end);
+
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    m_frames[m_frameCount % FRAME_HISTORY] = milliseconds;
+    ++m_frameCount;
+}
+
+void Profiler::record(const char* name, Clock::time_point start, Clock::time_point end)
+{
+    const Event event{name, microseconds(start), microseconds(end) - microseconds(start), threadNumber()};
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_events.size() < MAX_TRACE_EVENTS)
+    {
+        m_events.push_back(event);
+    }
+    else
+    {
+        ++m_droppedEvents;
+    }
+}
+
+Profiler::FrameStats Profiler::frameStats() const
+{
+    std::vector<float> frames;
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        frames.assign(m_frames.begin(), m_frames.begin() + std::min(m_frameCount, FRAME_HISTORY));
+    }
+
+    FrameStats stats;
+    stats.frames = frames.size();
+    if (frames.empty())
+    {
+        return stats;
+    }
+    for (const float milliseconds : frames)
+    {
+        const auto bucket = std::min(static_cast<std::size_t>(milliseconds), HISTOGRAM_BUCKETS - 1);
+        ++stats.histogram[bucket];
+    }
+    std::sort(frames.begin(), frames.end());
+    stats.p50 = percentile(frames, 0.50);
+    stats.p90 = percentile(frames, 0.90);
+    stats.p99 = percentile(frames, 0.99);
+    stats.max = frames.back();
+    return stats;
+}
+
+// Complete ("X") events in the Trace Event Format, timestamps in microseconds.
+bool Profiler::writeTrace(const std::string& path) const
+{
+    std::ofstream out(path, std::ios::trunc);
+    if (!out)
+    {
+        return false;
+    }
+
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    out << "{\"traceEvents\":[\n";
+    for (std::size_t i = 0; i < m_events.size(); ++i)
+    {
+        const Event& event = m_events[i];
+        out << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"ts\":" << event.start << ",\"dur\":" << event.duration
+            << ",\"pid\":1,\"tid\":" << event.thread << '}' << (i + 1 < m_events.size() ? ",\n" : "\n");
+    }
+    out << "],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":" << m_droppedEvents << "}}\n";
+    return static_cast<bool>(out);
+}
+
+std::int64_t Profiler::microseconds(Clock::time_point time) const
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(time - m_epoch).count();
+}
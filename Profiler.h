@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Frame-time profiler for the window. Scopes record how long named parts of a
+// frame take; frames feed percentiles and a histogram for the overlay, and
+// scopes can be written out as Chrome trace events (chrome://tracing or
+// Perfetto) for offline analysis.
+//
+// Only compiled in when CHECKERS_PROFILE is defined. Otherwise the macros at
+// the bottom expand to nothing, so a normal build makes no calls at all.
+class Profiler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Frames the statistics cover, about ten seconds at 60 Hz.
+    static constexpr std::size_t FRAME_HISTORY = 600;
+    // One bucket per millisecond; the last also holds every slower frame.
+    static constexpr std::size_t HISTOGRAM_BUCKETS = 34;
+    // Scopes kept for the trace; later ones are dropped.
+    static constexpr std::size_t MAX_TRACE_EVENTS = std::size_t{1} << 20;
+
+    struct FrameStats
+    {
+        std::size_t frames = 0;
+        double p50 = 0.0; // milliseconds
+        double p90 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+        std::array<std::uint32_t, HISTOGRAM_BUCKETS> histogram{};
+    };
+
+    // Times one scope, from construction to destruction.
+    class Scope
+    {
+    public:
+        explicit Scope(const char* name)
+            : m_name(name)
+            , m_start(Clock::now())
+        {
+        }
+        ~Scope()
+        {
+            instance().record(m_name, m_start, Clock::now());
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* m_name;
+        Clock::time_point m_start;
+    };
+
+    static Profiler& instance();
+
+    // A frame runs from beginFrame to endFrame; frames never ended (nothing
+    // was drawn) are not counted.
+    void beginFrame();
+    void endFrame();
+    // `name` must outlive the profiler; string literals do.
+    void record(const char* name, Clock::time_point start, Clock::time_point end);
+
+    FrameStats frameStats() const;
+    bool writeTrace(const std::string& path) const;
+
+private:
+    struct Event
+    {
+        const char* name;
+        std::int64_t start; // microseconds since m_epoch
+        std::int64_t duration;
+        std::uint32_t thread;
+    };
+
+    Profiler() = default;
+    std::int64_t microseconds(Clock::time_point time) const;
+
+    const Clock::time_point m_epoch = Clock::now();
+    Clock::time_point m_frameStart{};
+
+    mutable std::mutex m_mutex;
+    std::array<float, FRAME_HISTORY> m_frames{};
+    std::size_t m_frameCount = 0;
+    std::vector<Event> m_events;
+    std::size_t m_droppedEvents = 0;
+};
+
+#ifdef CHECKERS_PROFILE
+#define CHECKERS_PROFILE_JOIN_(a, b) a##b
+#define CHECKERS_PROFILE_JOIN(a, b) CHECKERS_PROFILE_JOIN_(a, b)
+#define CHECKERS_PROFILE_SCOPE(name) const Profiler::Scope CHECKERS_PROFILE_JOIN(profileScope, __LINE__)(name)
+#define CHECKERS_PROFILE_BEGIN_FRAME() Profiler::instance().beginFrame()
+#define CHECKERS_PROFILE_END_FRAME() Profiler::instance().endFrame()
+#else
+#define CHECKERS_PROFILE_SCOPE(name) static_cast<void>(0)
+#define CHECKERS_PROFILE_BEGIN_FRAME() static_cast<void>(0)
+#define CHECKERS_PROFILE_END_FRAME() static_cast<void>(0)
+#endif
@@ -0,0 +1,82 @@
+#include "ProfilerOverlay.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+constexpr float MARGIN = 10.f;
+constexpr float PADDING = 8.f;
+constexpr float BAR_WIDTH = 6.f;
+constexpr float HISTOGRAM_HEIGHT = 60.f;
+constexpr float TEXT_HEIGHT = 36.f;
+constexpr unsigned CHARACTER_SIZE = 13;
+// Bucket at which a 60 Hz frame misses its deadline.
+constexpr std::size_t BUDGET_BUCKET = 17;
+
+const sf::Color PANEL(0, 0, 0, 170);
+const sf::Color BAR(120, 220, 120);
+const sf::Color SLOW_BAR(240, 110, 90);
+const sf::Color BUDGET_LINE(255, 255, 255, 140);
+
+void appendRect(sf::VertexArray& vertices, sf::Vector2f position, sf::Vector2f size, sf::Color color)
+{
+    const sf::Vector2f a = position;
+    const sf::Vector2f b{position.x + size.x, position.y};
+    const sf::Vector2f c = position + size;
+    const sf::Vector2f d{position.x, position.y + size.y};
+    for (const sf::Vector2f& point : {a, b, c, a, c, d})
+    {
+        vertices.append({point, color, {}});
+    }
+}
+}
+
+void ProfilerOverlay::draw(sf::RenderTarget& target, const sf::Font* font, const Profiler::FrameStats& stats)
+{
+    const float width = 2.f * PADDING + BAR_WIDTH * static_cast<float>(Profiler::HISTOGRAM_BUCKETS);
+    const float height = 3.f * PADDING + TEXT_HEIGHT + HISTOGRAM_HEIGHT;
+    const sf::Vector2f origin{static_cast<float>(target.getSize().x) - width - MARGIN, MARGIN};
+
+    m_shapes.clear();
+    appendRect(m_shapes, origin, {width, height}, PANEL);
+
+    // Bars grow up from the bottom of the panel, scaled to the fullest bucket.
+    const std::uint32_t tallest = std::max<std::uint32_t>(
+        1, *std::max_element(stats.histogram.begin(), stats.histogram.end()));
+    const float baseline = origin.y + height - PADDING;
+    for (std::size_t bucket = 0; bucket < Profiler::HISTOGRAM_BUCKETS; ++bucket)
+    {
+        const float barHeight = HISTOGRAM_HEIGHT * static_cast<float>(stats.histogram[bucket]) / static_cast<float>(tallest);
+        const float left = origin.x + PADDING + BAR_WIDTH * static_cast<float>(bucket);
+        appendRect(m_shapes,
+                   {left, baseline - barHeight},
+                   {BAR_WIDTH - 1.f, barHeight},
+                   bucket < BUDGET_BUCKET ? BAR : SLOW_BAR);
+    }
+    const float budgetX = origin.x + PADDING + BAR_WIDTH * static_cast<float>(BUDGET_BUCKET) - 1.f;
+    appendRect(m_shapes, {budgetX, baseline - HISTOGRAM_HEIGHT}, {1.f, HISTOGRAM_HEIGHT}, BUDGET_LINE);
+    target.draw(m_shapes);
+
+    if (font == nullptr)
+    {
+        return;
+    }
+    if (!m_text)
+    {
+        m_text.emplace(*font, "", CHARACTER_SIZE);
+        m_text->setFillColor(sf::Color::White);
+    }
+    char line[128];
+    std::snprintf(line,
+                  sizeof(line),
+                  "frame ms  p50 %.1f  p90 %.1f\np99 %.1f  max %.1f  (%zu)",
+                  stats.p50,
+                  stats.p90,
+                  stats.p99,
+                  stats.max,
+                  stats.frames);
+    m_text->setString(line);
+    m_text->setPosition({origin.x + PADDING, origin.y + PADDING});
+    target.draw(*m_text);
+}
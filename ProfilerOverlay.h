@@ -0,0 +1,20 @@
+#pragma once
+
+#include <optional>
+
+#include <SFML/Graphics.hpp>
+
+#include "Profiler.h"
+
+// Draws the profiler's frame-time percentiles and histogram in a corner of
+// the window, with the 60 Hz frame budget marked on the histogram.
+class ProfilerOverlay
+{
+public:
+    // Text is left out when there is no font.
+    void draw(sf::RenderTarget& target, const sf::Font* font, const Profiler::FrameStats& stats);
+
+private:
+    sf::VertexArray m_shapes{sf::PrimitiveType::Triangles};
+    std::optional<sf::Text> m_text;
+};
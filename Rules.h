@@ -0,0 +1,69 @@
+#pragma once
+
+// Rule sets for BasicBoard (Board.h). Every rule is a compile-time constant,
+// so each variant's move generator is compiled on its own with the rules it
+// does not have folded away.
+
+// What happens when a man reaches the far row in the middle of a capture.
+enum class CrowningInCapture
+{
+    ContinuesAsKing, // crowned at once, and goes on capturing as a king
+    EndsMove,        // crowned, and the capture stops there
+    OnlyAtEnd        // passes over the row as a man; crowned only if the capture ends on it
+};
+
+// The rules this game has always played: flying kings, men capturing forward
+// only, and captured pieces leaving the board as they are jumped.
+struct HouseRules
+{
+    static constexpr bool FLYING_KINGS = true;
+    // A flying king that jumps a piece must land where it can capture again,
+    // if any square beyond it allows that.
+    static constexpr bool KINGS_LAND_TO_CONTINUE = false;
+    static constexpr bool MEN_CAPTURE_BACKWARDS = false;
+    // Only captures of the most pieces are legal.
+    static constexpr bool MAXIMUM_CAPTURE = false;
+    static constexpr CrowningInCapture CROWNING = CrowningInCapture::ContinuesAsKing;
+    // Otherwise jumped pieces stay until the move ends: they block the rest
+    // of the capture and cannot be jumped twice.
+    static constexpr bool REMOVE_WHEN_JUMPED = true;
+    // Captures taking the same pieces to the same square count as one move,
+    // whatever order the pieces were jumped in.
+    static constexpr bool MERGE_EQUAL_CAPTURES = false;
+};
+
+// English draughts (checkers).
+struct EnglishRules
+{
+    static constexpr bool FLYING_KINGS = false;
+    static constexpr bool KINGS_LAND_TO_CONTINUE = false;
+    static constexpr bool MEN_CAPTURE_BACKWARDS = false;
+    static constexpr bool MAXIMUM_CAPTURE = false;
+    static constexpr CrowningInCapture CROWNING = CrowningInCapture::EndsMove;
+    static constexpr bool REMOVE_WHEN_JUMPED = false;
+    static constexpr bool MERGE_EQUAL_CAPTURES = false;
+};
+
+// Russian draughts.
+struct RussianRules
+{
+    static constexpr bool FLYING_KINGS = true;
+    static constexpr bool KINGS_LAND_TO_CONTINUE = true;
+    static constexpr bool MEN_CAPTURE_BACKWARDS = true;
+    static constexpr bool MAXIMUM_CAPTURE = false;
+    static constexpr CrowningInCapture CROWNING = CrowningInCapture::ContinuesAsKing;
+    static constexpr bool REMOVE_WHEN_JUMPED = false;
+    static constexpr bool MERGE_EQUAL_CAPTURES = false;
+};
+
+// International draughts, played on 10x10.
+struct InternationalRules
+{
+    static constexpr bool FLYING_KINGS = true;
+    static constexpr bool KINGS_LAND_TO_CONTINUE = true;
+    static constexpr bool MEN_CAPTURE_BACKWARDS = true;
+    static constexpr bool MAXIMUM_CAPTURE = true;
+    static constexpr CrowningInCapture CROWNING = CrowningInCapture::OnlyAtEnd;
+    static constexpr bool REMOVE_WHEN_JUMPED = false;
+    static constexpr bool MERGE_EQUAL_CAPTURES = true;
+};
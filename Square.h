@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+// A board coordinate, two bytes instead of sf::Vector2i's eight. Any (row,
+// col) pair can be held, including ones off the board, so a step can be
+// taken before checking Board::isInside.
+struct Square
+{
+    std::int8_t row = 0;
+    std::int8_t col = 0;
+
+    constexpr Square() = default;
+    constexpr Square(int rowValue, int colValue)
+        : row(static_cast<std::int8_t>(rowValue))
+        , col(static_cast<std::int8_t>(colValue))
+    {
+    }
+
+    constexpr bool operator==(const Square& other) const = default;
+
+    constexpr Square operator+(const Square& step) const
+    {
+        return Square(row + step.row, col + step.col);
+    }
+
+    constexpr Square& operator+=(const Square& step)
+    {
+        return *this = *this + step;
+    }
+};
@@ -0,0 +1,232 @@
+#include "Stats.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+using Values = std::array<std::uint64_t, Stats::COUNTERS>;
+
+constexpr std::array<std::string_view, Stats::COUNTERS> NAMES = {
+    "pieceMoveCalls",
+    "generateCalls",
+    "movesGenerated",
+    "capturesGenerated",
+    "applyMoveCalls",
+    "makeMoveCalls",
+    "nodes",
+    "quiescenceNodes",
+    "cutoffs",
+    "tableProbes",
+    "tableHits",
+    "tablebaseHits",
+};
+
+// Blocks of running threads, and what exited threads counted.
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<const Stats::detail::Block*> live;
+    Values retired{};
+};
+
+Registry& registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+void addBlock(Values& totals, const Stats::detail::Block& block)
+{
+    for (std::size_t i = 0; i < Stats::COUNTERS; ++i)
+    {
+        totals[i] += block.values[i].load(std::memory_order_relaxed);
+    }
+}
+
+// Owns a thread's block; folds it into the retired totals when the thread exits.
+struct ThreadBlock
+{
+    Stats::detail::Block block;
+
+    ThreadBlock()
+    {
+        Registry& shared = registry();
+        const std::lock_guard<std::mutex> lock(shared.mutex);
+        shared.live.push_back(&block);
+    }
+
+    ~ThreadBlock()
+    {
+        Registry& shared = registry();
+        const std::lock_guard<std::mutex> lock(shared.mutex);
+        addBlock(shared.retired, block);
+        shared.live.erase(std::find(shared.live.begin(), shared.live.end(), &block));
+        Stats::detail::t_block = nullptr;
+    }
+};
+
+double ratio(std::uint64_t part, std::uint64_t whole)
+{
+    return whole > 0 ? static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+}
+
+double perSecond(std::uint64_t count, double seconds)
+{
+    return seconds > 0 ? static_cast<double>(count) / seconds : 0.0;
+}
+}
+
+namespace Stats
+{
+std::string_view name(Counter counter)
+{
+    return NAMES[static_cast<std::size_t>(counter)];
+}
+
+detail::Block& detail::registerThread()
+{
+    thread_local ThreadBlock owner;
+    t_block = &owner.block;
+    return owner.block;
+}
+
+std::uint64_t Snapshot::operator[](Counter counter) const
+{
+    return values[static_cast<std::size_t>(counter)];
+}
+
+Snapshot Snapshot::operator-(const Snapshot& earlier) const
+{
+    Snapshot difference;
+    for (std::size_t i = 0; i < COUNTERS; ++i)
+    {
+        difference.values[i] = values[i] - earlier.values[i];
+    }
+    return difference;
+}
+
+double Snapshot::movesPerGeneration() const
+{
+    return ratio((*this)[Counter::MovesGenerated], (*this)[Counter::GenerateCalls] + (*this)[Counter::PieceMoveCalls]);
+}
+
+double Snapshot::captureRatio() const
+{
+    return ratio((*this)[Counter::CapturesGenerated], (*this)[Counter::MovesGenerated]);
+}
+
+double Snapshot::tableHitRate() const
+{
+    return ratio((*this)[Counter::TableHits], (*this)[Counter::TableProbes]);
+}
+
+double Snapshot::cutoffRate() const
+{
+    return ratio((*this)[Counter::Cutoffs], (*this)[Counter::Nodes]);
+}
+
+Snapshot snapshot()
+{
+    Registry& shared = registry();
+    const std::lock_guard<std::mutex> lock(shared.mutex);
+    Snapshot result;
+    result.values = shared.retired;
+    for (const detail::Block* block : shared.live)
+    {
+        addBlock(result.values, *block);
+    }
+    return result;
+}
+
+void writeJson(std::ostream& out, const Snapshot& stats, double seconds)
+{
+    out << "{\"seconds\":" << seconds;
+    for (std::size_t i = 0; i < COUNTERS; ++i)
+    {
+        out << ",\"" << NAMES[i] << "\":" << stats.values[i];
+    }
+    out << ",\"nodesPerSecond\":" << perSecond(stats[Counter::Nodes], seconds)
+        << ",\"movesPerGeneration\":" << stats.movesPerGeneration() << ",\"captureRatio\":" << stats.captureRatio()
+        << ",\"tableHitRate\":" << stats.tableHitRate() << ",\"cutoffRate\":" << stats.cutoffRate() << "}\n";
+}
+
+void writeCsvHeader(std::ostream& out)
+{
+    out << "seconds";
+    for (const std::string_view counterName : NAMES)
+    {
+        out << ',' << counterName;
+    }
+    out << ",nodesPerSecond,movesPerGeneration,captureRatio,tableHitRate,cutoffRate\n";
+}
+
+void writeCsv(std::ostream& out, const Snapshot& stats, double seconds)
+{
+    out << seconds;
+    for (const std::uint64_t value : stats.values)
+    {
+        out << ',' << value;
+    }
+    out << ',' << perSecond(stats[Counter::Nodes], seconds) << ',' << stats.movesPerGeneration() << ','
+        << stats.captureRatio() << ',' << stats.tableHitRate() << ',' << stats.cutoffRate() << '\n';
+}
+
+Reporter::Reporter(std::ostream& out, Format format, std::chrono::milliseconds interval)
+    : m_out(out)
+    , m_format(format)
+    , m_interval(interval)
+{
+    if (m_format == Format::Csv)
+    {
+        writeCsvHeader(m_out);
+    }
+    if (m_interval.count() > 0)
+    {
+        m_thread = std::thread(&Reporter::run, this);
+    }
+}
+
+Reporter::~Reporter()
+{
+    {
+        const std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+    write(snapshot() - m_start, seconds);
+}
+
+void Reporter::run()
+{
+    Snapshot previous = m_start;
+    auto previousTime = m_startTime;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_wake.wait_for(lock, m_interval, [this] { return m_stopping; }))
+    {
+        const Snapshot current = snapshot();
+        const auto now = std::chrono::steady_clock::now();
+        write(current - previous, std::chrono::duration<double>(now - previousTime).count());
+        previous = current;
+        previousTime = now;
+    }
+}
+
+void Reporter::write(const Snapshot& stats, double seconds)
+{
+    if (m_format == Format::Json)
+    {
+        writeJson(m_out, stats, seconds);
+    }
+    else
+    {
+        writeCsv(m_out, stats, seconds);
+    }
+    m_out.flush();
+}
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <thread>
+
+// Event counters for the rules and the search. Every thread counts into a
+// block of its own, with a relaxed load and store rather than a locked
+// read-modify-write since it is the only writer; a snapshot sums the blocks
+// of all threads, including ones that have exited. Nothing on the counting
+// path is shared between threads, so counting never contends.
+namespace Stats
+{
+enum class Counter : std::uint8_t
+{
+    PieceMoveCalls,  // Board::getMovesForPiece
+    GenerateCalls,   // Board::getAllMoves and getLegalMoves
+    MovesGenerated,  // by all of the above
+    CapturesGenerated,
+    ApplyMoveCalls,
+    MakeMoveCalls,
+    Nodes,           // search nodes, quiescence included
+    QuiescenceNodes,
+    Cutoffs,         // beta cutoffs
+    TableProbes,
+    TableHits,
+    TablebaseHits,
+    Count
+};
+
+constexpr std::size_t COUNTERS = static_cast<std::size_t>(Counter::Count);
+
+// camelCase, as used for JSON keys and CSV columns.
+std::string_view name(Counter counter);
+
+namespace detail
+{
+struct Block
+{
+    std::array<std::atomic<std::uint64_t>, COUNTERS> values{};
+};
+
+inline thread_local Block* t_block = nullptr;
+Block& registerThread();
+}
+
+inline void add(Counter counter, std::uint64_t amount = 1)
+{
+    detail::Block* block = detail::t_block;
+    if (block == nullptr)
+    {
+        block = &detail::registerThread();
+    }
+    std::atomic<std::uint64_t>& value = block->values[static_cast<std::size_t>(counter)];
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+// Totals at one moment. Counters only grow, so the activity over an interval
+// is the difference of two snapshots.
+struct Snapshot
+{
+    std::array<std::uint64_t, COUNTERS> values{};
+
+    std::uint64_t operator[](Counter counter) const;
+    Snapshot operator-(const Snapshot& earlier) const;
+
+    double movesPerGeneration() const;
+    double captureRatio() const; // captures among generated moves
+    double tableHitRate() const;
+    double cutoffRate() const;   // cutoffs per node
+};
+
+Snapshot snapshot();
+
+// One line per snapshot: a JSON object, or CSV under a header line. `seconds`
+// is the time the snapshot covers, for the nodes per second column.
+void writeJson(std::ostream& out, const Snapshot& stats, double seconds);
+void writeCsvHeader(std::ostream& out);
+void writeCsv(std::ostream& out, const Snapshot& stats, double seconds);
+
+enum class Format
+{
+    Json,
+    Csv
+};
+
+// Writes the counts of each interval on a thread of its own, and a last
+// line with the totals since it started when destroyed.
+class Reporter
+{
+public:
+    Reporter(std::ostream& out, Format format, std::chrono::milliseconds interval);
+    ~Reporter();
+    Reporter(const Reporter&) = delete;
+    Reporter& operator=(const Reporter&) = delete;
+
+private:
+    void run();
+    void write(const Snapshot& stats, double seconds);
+
+    std::ostream& m_out;
+    const Format m_format;
+    const std::chrono::milliseconds m_interval;
+    const Snapshot m_start = snapshot();
+    const std::chrono::steady_clock::time_point m_startTime = std::chrono::steady_clock::now();
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping = false;
+    std::thread m_thread;
+};
+}
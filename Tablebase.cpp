@@ -0,0 +1,410 @@
+#include "Tablebase.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+using Bitboard = Board::Bitboard;
+
+constexpr int HALF = Board::SIZE / 2;
+// Men never stand on their own promotion row.
+constexpr int MAN_SQUARES = Board::SQUARES - HALF;
+constexpr int MAX_GROUP = Board::PIECES_PER_SIDE;
+// The first side's men are crowned on row 0 and the second side's on the last
+// row, so their squares are counted from row 1 and row 0 respectively.
+constexpr int FIRST_MEN_OFFSET = HALF;
+constexpr int SECOND_MEN_OFFSET = 0;
+
+constexpr char MAGIC[8] = {'C', 'K', 'R', 'T', 'B', '0', '0', '1'};
+
+// On-disk layout, native byte order: header, one record per slice, the byte
+// offset of every block (plus an end offset), then the compressed blocks.
+struct FileHeader
+{
+    char magic[8];
+    std::uint32_t maxPieces;
+    std::uint32_t sliceCount;
+    std::uint32_t blockEntries;
+    std::uint32_t reserved;
+    std::uint64_t blockCount;
+};
+
+struct SliceRecord
+{
+    std::uint8_t firstMen;
+    std::uint8_t firstKings;
+    std::uint8_t secondMen;
+    std::uint8_t secondKings;
+    std::uint32_t reserved;
+    std::uint64_t entries;
+};
+
+using BinomialTable = std::array<std::array<std::uint64_t, MAX_GROUP + 1>, Board::SQUARES + 1>;
+
+constexpr BinomialTable makeBinomials()
+{
+    BinomialTable table{};
+    for (int n = 0; n <= Board::SQUARES; ++n)
+    {
+        table[n][0] = 1;
+        for (int k = 1; k <= MAX_GROUP && k <= n; ++k)
+        {
+            table[n][k] = table[n - 1][k - 1] + (k <= n - 1 ? table[n - 1][k] : 0);
+        }
+    }
+    return table;
+}
+
+constexpr BinomialTable BINOMIALS = makeBinomials();
+
+std::uint64_t binomial(int n, int k)
+{
+    return k <= n ? BINOMIALS[n][k] : 0;
+}
+
+// Colex rank of a set of squares, counted from `offset`.
+std::uint64_t rankSquares(Bitboard squares, int offset)
+{
+    std::uint64_t rank = 0;
+    for (int k = 1; squares; ++k)
+    {
+        rank += binomial(std::countr_zero(squares) - offset, k);
+        squares &= squares - 1;
+    }
+    return rank;
+}
+
+Bitboard unrankSquares(std::uint64_t rank, int count, int range, int offset)
+{
+    Bitboard squares = 0;
+    int limit = range;
+    for (int k = count; k > 0; --k)
+    {
+        int position = k - 1;
+        while (position + 1 < limit && binomial(position + 1, k) <= rank)
+        {
+            ++position;
+        }
+        rank -= binomial(position, k);
+        squares |= Bitboard{1} << (position + offset);
+        limit = position;
+    }
+    return squares;
+}
+}
+
+int Tablebase::Material::total() const
+{
+    return firstMen + firstKings + secondMen + secondKings;
+}
+
+Tablebase::Tablebase(std::size_t cacheBlocks)
+    : m_shardCapacity(std::max<std::size_t>(1, (cacheBlocks + CACHE_SHARDS - 1) / CACHE_SHARDS))
+{
+}
+
+bool Tablebase::open(const std::string& path)
+{
+    close();
+    if (!m_file.open(path) || m_file.size() < sizeof(FileHeader))
+    {
+        close();
+        return false;
+    }
+    const std::uint8_t* data = m_file.data();
+    const std::size_t size = m_file.size();
+
+    FileHeader header{};
+    std::memcpy(&header, data, sizeof(header));
+    const std::size_t recordsEnd = sizeof(FileHeader) + header.sliceCount * sizeof(SliceRecord);
+    const std::size_t offsetsEnd = recordsEnd + (header.blockCount + 1) * sizeof(std::uint64_t);
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.blockEntries != BLOCK_ENTRIES
+        || header.maxPieces > static_cast<std::uint32_t>(2 * Board::PIECES_PER_SIDE) || offsetsEnd > size)
+    {
+        close();
+        return false;
+    }
+
+    m_maxPieces = static_cast<int>(header.maxPieces);
+    m_slices.assign(slotCount(m_maxPieces), Slice{});
+    std::uint64_t nextBlock = 0;
+    for (std::uint32_t i = 0; i < header.sliceCount; ++i)
+    {
+        SliceRecord record{};
+        std::memcpy(&record, data + sizeof(FileHeader) + i * sizeof(SliceRecord), sizeof(record));
+        const Material material{record.firstMen, record.firstKings, record.secondMen, record.secondKings};
+        const int slot = slotOf(material, m_maxPieces);
+        if (slot < 0 || record.entries != sliceSize(material))
+        {
+            close();
+            return false;
+        }
+        m_slices[slot] = Slice{record.entries, nextBlock};
+        nextBlock += (record.entries + BLOCK_ENTRIES - 1) / BLOCK_ENTRIES;
+    }
+
+    m_blockCount = header.blockCount;
+    m_blockOffsets = reinterpret_cast<const std::uint64_t*>(data + recordsEnd);
+    m_blockData = data + offsetsEnd;
+    if (nextBlock != m_blockCount || m_blockOffsets[m_blockCount] > size - offsetsEnd)
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void Tablebase::close()
+{
+    m_file.close();
+    m_blockOffsets = nullptr;
+    m_blockData = nullptr;
+    m_blockCount = 0;
+    m_maxPieces = 0;
+    m_slices.clear();
+
+    for (auto& shard : m_cacheShards)
+    {
+        std::lock_guard lock(shard.mutex);
+        shard.blocks.clear();
+        shard.index.clear();
+    }
+}
+
+bool Tablebase::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+int Tablebase::maxPieces() const
+{
+    return m_maxPieces;
+}
+
+std::optional<Tablebase::Result> Tablebase::probe(const Board& board) const
+{
+    if (!m_file.isOpen())
+    {
+        return std::nullopt;
+    }
+
+    const Material material = materialOf(board);
+    const int slot = slotOf(material, m_maxPieces);
+    if (slot < 0 || m_slices[slot].entries == 0)
+    {
+        return std::nullopt;
+    }
+
+    const std::uint64_t index = indexOf(board);
+    return decode(lookup(m_slices[slot].firstBlock + index / BLOCK_ENTRIES, index % BLOCK_ENTRIES));
+}
+
+Tablebase::Material Tablebase::materialOf(const Board& board)
+{
+    const Bitboard first = board.piecesOf(PieceColor::First);
+    const Bitboard second = board.piecesOf(PieceColor::Second);
+    const Bitboard kings = board.kings();
+    return Material{std::popcount(first & ~kings), std::popcount(first & kings), std::popcount(second & ~kings),
+                    std::popcount(second & kings)};
+}
+
+int Tablebase::slotOf(const Material& material, int maxPieces)
+{
+    const int base = maxPieces + 1;
+    const int firstCount = material.firstMen + material.firstKings;
+    const int secondCount = material.secondMen + material.secondKings;
+    if (firstCount == 0 || secondCount == 0 || material.total() > maxPieces)
+    {
+        return -1;
+    }
+    return ((material.firstMen * base + material.firstKings) * base + material.secondMen) * base + material.secondKings;
+}
+
+std::size_t Tablebase::slotCount(int maxPieces)
+{
+    const std::size_t base = static_cast<std::size_t>(maxPieces) + 1;
+    return base * base * base * base;
+}
+
+std::uint64_t Tablebase::sliceSize(const Material& material)
+{
+    return binomial(MAN_SQUARES, material.firstMen) * binomial(Board::SQUARES, material.firstKings)
+         * binomial(MAN_SQUARES, material.secondMen) * binomial(Board::SQUARES, material.secondKings) * 2;
+}
+
+std::uint64_t Tablebase::indexOf(const Board& board)
+{
+    const Material material = materialOf(board);
+    const Bitboard first = board.piecesOf(PieceColor::First);
+    const Bitboard second = board.piecesOf(PieceColor::Second);
+    const Bitboard kings = board.kings();
+
+    std::uint64_t index = rankSquares(first & ~kings, FIRST_MEN_OFFSET);
+    index = index * binomial(Board::SQUARES, material.firstKings) + rankSquares(first & kings, 0);
+    index = index * binomial(MAN_SQUARES, material.secondMen) + rankSquares(second & ~kings, SECOND_MEN_OFFSET);
+    index = index * binomial(Board::SQUARES, material.secondKings) + rankSquares(second & kings, 0);
+    return index * 2 + (board.sideToMove() == PieceColor::Second ? 1 : 0);
+}
+
+bool Tablebase::positionAt(const Material& material, std::uint64_t index, Board& board)
+{
+    const PieceColor toMove = index % 2 == 0 ? PieceColor::First : PieceColor::Second;
+    index /= 2;
+
+    const std::uint64_t secondKingsCount = binomial(Board::SQUARES, material.secondKings);
+    const std::uint64_t secondMenCount = binomial(MAN_SQUARES, material.secondMen);
+    const std::uint64_t firstKingsCount = binomial(Board::SQUARES, material.firstKings);
+
+    const Bitboard secondKings = unrankSquares(index % secondKingsCount, material.secondKings, Board::SQUARES, 0);
+    index /= secondKingsCount;
+    const Bitboard secondMen = unrankSquares(index % secondMenCount, material.secondMen, MAN_SQUARES, SECOND_MEN_OFFSET);
+    index /= secondMenCount;
+    const Bitboard firstKings = unrankSquares(index % firstKingsCount, material.firstKings, Board::SQUARES, 0);
+    index /= firstKingsCount;
+    const Bitboard firstMen = unrankSquares(index, material.firstMen, MAN_SQUARES, FIRST_MEN_OFFSET);
+
+    const int placed = std::popcount(firstMen | firstKings | secondMen | secondKings);
+    if (placed != material.total())
+    {
+        return false;
+    }
+
+    board.setPosition(firstMen | firstKings, secondMen | secondKings, firstKings | secondKings, toMove);
+    return true;
+}
+
+Tablebase::Value Tablebase::encode(const Result& result)
+{
+    const int distance = std::clamp(result.distance, 0, MAX_DISTANCE);
+    switch (result.outcome)
+    {
+    case Outcome::Win:
+        return static_cast<Value>(std::max(distance, 1));
+    case Outcome::Loss:
+        return static_cast<Value>(MAX_DISTANCE + 1 + distance);
+    case Outcome::Draw:
+        break;
+    }
+    return 0;
+}
+
+Tablebase::Result Tablebase::decode(Value value)
+{
+    if (value == 0)
+    {
+        return Result{Outcome::Draw, 0};
+    }
+    if (value <= MAX_DISTANCE)
+    {
+        return Result{Outcome::Win, value};
+    }
+    return Result{Outcome::Loss, value - MAX_DISTANCE - 1};
+}
+
+void Tablebase::compressBlock(const Value* values, std::size_t count, std::vector<std::uint8_t>& out)
+{
+    std::size_t i = 0;
+    while (i < count)
+    {
+        std::size_t run = 1;
+        while (i + run < count && run < 255 && values[i + run] == values[i])
+        {
+            ++run;
+        }
+        out.push_back(static_cast<std::uint8_t>(run));
+        out.push_back(values[i]);
+        i += run;
+    }
+}
+
+bool Tablebase::write(const std::string& path,
+                      int maxPieces,
+                      const std::vector<Material>& materials,
+                      const std::vector<std::vector<Value>>& values)
+{
+    std::vector<std::uint8_t> data;
+    std::vector<std::uint64_t> offsets;
+    for (const auto& slice : values)
+    {
+        for (std::size_t start = 0; start < slice.size(); start += BLOCK_ENTRIES)
+        {
+            offsets.push_back(data.size());
+            compressBlock(slice.data() + start, std::min<std::size_t>(BLOCK_ENTRIES, slice.size() - start), data);
+        }
+    }
+    const std::uint64_t blockCount = offsets.size();
+    offsets.push_back(data.size());
+
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.maxPieces = static_cast<std::uint32_t>(maxPieces);
+    header.sliceCount = static_cast<std::uint32_t>(materials.size());
+    header.blockEntries = BLOCK_ENTRIES;
+    header.blockCount = blockCount;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (std::size_t i = 0; i < materials.size(); ++i)
+    {
+        const Material& material = materials[i];
+        SliceRecord record{};
+        record.firstMen = static_cast<std::uint8_t>(material.firstMen);
+        record.firstKings = static_cast<std::uint8_t>(material.firstKings);
+        record.secondMen = static_cast<std::uint8_t>(material.secondMen);
+        record.secondKings = static_cast<std::uint8_t>(material.secondKings);
+        record.entries = values[i].size();
+        out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    }
+    out.write(reinterpret_cast<const char*>(offsets.data()), static_cast<std::streamsize>(offsets.size() * sizeof(std::uint64_t)));
+    out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(out);
+}
+
+Tablebase::Value Tablebase::lookup(std::uint64_t block, std::size_t offset) const
+{
+    CacheShard& shard = m_cacheShards[block % CACHE_SHARDS];
+    std::lock_guard lock(shard.mutex);
+    auto& blocks = shard.blocks;
+    if (const auto found = shard.index.find(block); found != shard.index.end())
+    {
+        if (found->second != blocks.begin())
+        {
+            blocks.splice(blocks.begin(), blocks, found->second);
+        }
+        return blocks.front().values[offset];
+    }
+
+    // Reuse the least recently used block's storage once the shard is full.
+    if (blocks.size() >= m_shardCapacity)
+    {
+        shard.index.erase(blocks.back().id);
+        blocks.splice(blocks.begin(), blocks, std::prev(blocks.end()));
+    }
+    else
+    {
+        blocks.emplace_front();
+    }
+
+    CachedBlock& cached = blocks.front();
+    cached.id = block;
+    decompressBlock(block, cached.values);
+    shard.index[block] = blocks.begin();
+    return cached.values[offset];
+}
+
+void Tablebase::decompressBlock(std::uint64_t block, Block& values) const
+{
+    values.fill(0);
+    const std::uint8_t* in = m_blockData + m_blockOffsets[block];
+    const std::uint8_t* end = m_blockData + m_blockOffsets[block + 1];
+    std::size_t filled = 0;
+    for (; in + 1 < end && filled < values.size(); in += 2)
+    {
+        const std::size_t run = std::min<std::size_t>(in[0], values.size() - filled);
+        std::fill_n(values.begin() + static_cast<std::ptrdiff_t>(filled), run, in[1]);
+        filled += run;
+    }
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Board.h"
+#include "MappedFile.h"
+
+// Endgame databases: the exact result of every position with few pieces, as
+// built by TablebaseGenerator. The file is memory-mapped and read lazily, so
+// only the blocks a game or search actually touches are paged in and
+// decompressed; recently used blocks stay decompressed in an LRU cache,
+// split into shards with their own locks so search threads rarely wait.
+//
+// A file holds one slice per material combination. Within a slice, each
+// group of pieces (first men, first kings, second men, second kings) is
+// ranked as a combination of squares and the side to move is the lowest
+// digit. Men are ranked over the 28 squares they can stand on without having
+// been crowned.
+class Tablebase
+{
+public:
+    enum class Outcome
+    {
+        Draw,
+        Win, // for the side to move
+        Loss
+    };
+
+    struct Result
+    {
+        Outcome outcome = Outcome::Draw;
+        int distance = 0; // plies to the end of the game with best play, capped at MAX_DISTANCE
+    };
+
+    struct Material
+    {
+        int firstMen = 0;
+        int firstKings = 0;
+        int secondMen = 0;
+        int secondKings = 0;
+
+        int total() const;
+        bool operator==(const Material& other) const = default;
+    };
+
+    // One byte per position: 0 is a draw, 1..127 a win in that many plies,
+    // 128 + n a loss in n plies.
+    using Value = std::uint8_t;
+    static constexpr int MAX_DISTANCE = 127;
+    static constexpr int BLOCK_ENTRIES = 4096;
+    static constexpr std::size_t DEFAULT_CACHE_BLOCKS = 256;
+    static constexpr std::size_t CACHE_SHARDS = 16;
+
+    // cacheBlocks is shared evenly between the shards, at least one block each.
+    explicit Tablebase(std::size_t cacheBlocks = DEFAULT_CACHE_BLOCKS);
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+    int maxPieces() const;
+
+    // Empty when the position is not covered by the file.
+    std::optional<Result> probe(const Board& board) const;
+
+    static Material materialOf(const Board& board);
+    // Dense numbering of the materials with at most maxPieces pieces; -1 when out of range.
+    static int slotOf(const Material& material, int maxPieces);
+    static std::size_t slotCount(int maxPieces);
+    static std::uint64_t sliceSize(const Material& material);
+    static std::uint64_t indexOf(const Board& board);
+    // False when the index does not decode to a reachable position.
+    static bool positionAt(const Material& material, std::uint64_t index, Board& board);
+
+    static Value encode(const Result& result);
+    static Result decode(Value value);
+
+    // RLE over (run length, value) byte pairs.
+    static void compressBlock(const Value* values, std::size_t count, std::vector<std::uint8_t>& out);
+
+    // Builds the file from every slice up to maxPieces, in the order given.
+    static bool write(const std::string& path,
+                      int maxPieces,
+                      const std::vector<Material>& materials,
+                      const std::vector<std::vector<Value>>& values);
+
+private:
+    struct Slice
+    {
+        std::uint64_t entries = 0;
+        std::uint64_t firstBlock = 0;
+    };
+
+    using Block = std::array<Value, BLOCK_ENTRIES>;
+
+    struct CachedBlock
+    {
+        std::uint64_t id = 0;
+        Block values{};
+    };
+
+    // Block ids are spread over the shards by their low bits, so neighbouring
+    // blocks of one slice land in different shards.
+    struct CacheShard
+    {
+        std::mutex mutex;
+        std::list<CachedBlock> blocks; // most recently used first
+        std::unordered_map<std::uint64_t, std::list<CachedBlock>::iterator> index;
+    };
+
+    Value lookup(std::uint64_t block, std::size_t offset) const;
+    void decompressBlock(std::uint64_t block, Block& values) const;
+
+    MappedFile m_file;
+    const std::uint64_t* m_blockOffsets = nullptr;
+    const std::uint8_t* m_blockData = nullptr;
+    std::uint64_t m_blockCount = 0;
+    int m_maxPieces = 0;
+    // Indexed by slotOf; slices not in the file have no entries.
+    std::vector<Slice> m_slices;
+
+    std::size_t m_shardCapacity;
+    mutable std::array<CacheShard, CACHE_SHARDS> m_cacheShards;
+};
@@ -0,0 +1,314 @@
+#include "TablebaseGenerator.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace
+{
+using Bitboard = Board::Bitboard;
+using Outcome = Tablebase::Outcome;
+
+// Positions are numbered with 32 bits while solving.
+constexpr std::uint64_t MAX_SLICE_SIZE = UINT32_MAX;
+
+struct Pending
+{
+    std::uint32_t index;
+    bool win;
+};
+
+PieceColor opponent(PieceColor color)
+{
+    return color == PieceColor::First ? PieceColor::Second : PieceColor::First;
+}
+
+int menCount(const Tablebase::Material& material)
+{
+    return material.firstMen + material.secondMen;
+}
+}
+
+TablebaseGenerator::TablebaseGenerator(int maxPieces)
+    : m_maxPieces(maxPieces)
+    , m_sliceOfSlot(Tablebase::slotCount(maxPieces), -1)
+{
+    for (int firstMen = 0; firstMen <= maxPieces; ++firstMen)
+    {
+        for (int firstKings = 0; firstMen + firstKings <= maxPieces; ++firstKings)
+        {
+            for (int secondMen = 0; firstMen + firstKings + secondMen <= maxPieces; ++secondMen)
+            {
+                for (int secondKings = 0; firstMen + firstKings + secondMen + secondKings <= maxPieces; ++secondKings)
+                {
+                    const Tablebase::Material material{firstMen, firstKings, secondMen, secondKings};
+                    if (firstMen + firstKings <= Board::PIECES_PER_SIDE && secondMen + secondKings <= Board::PIECES_PER_SIDE
+                        && Tablebase::slotOf(material, maxPieces) >= 0)
+                    {
+                        m_materials.push_back(material);
+                    }
+                }
+            }
+        }
+    }
+
+    std::stable_sort(m_materials.begin(), m_materials.end(), [](const auto& a, const auto& b) {
+        if (a.total() != b.total())
+        {
+            return a.total() < b.total();
+        }
+        return menCount(a) < menCount(b);
+    });
+    for (std::size_t i = 0; i < m_materials.size(); ++i)
+    {
+        m_sliceOfSlot[Tablebase::slotOf(m_materials[i], maxPieces)] = static_cast<int>(i);
+    }
+}
+
+void TablebaseGenerator::generate(const Progress& progress)
+{
+    m_results.assign(m_materials.size(), {});
+    for (std::size_t slice = 0; slice < m_materials.size(); ++slice)
+    {
+        solveSlice(slice);
+        if (progress)
+        {
+            progress(m_materials[slice], m_results[slice].size());
+        }
+    }
+}
+
+bool TablebaseGenerator::write(const std::string& path) const
+{
+    std::vector<std::vector<Tablebase::Value>> values(m_results.size());
+    for (std::size_t slice = 0; slice < m_results.size(); ++slice)
+    {
+        values[slice].reserve(m_results[slice].size());
+        for (const Exact exact : m_results[slice])
+        {
+            values[slice].push_back(Tablebase::encode(decodeExact(exact)));
+        }
+    }
+    return Tablebase::write(path, m_maxPieces, m_materials, values);
+}
+
+Tablebase::Result TablebaseGenerator::resultOf(const Board& board) const
+{
+    if (board.piecesOf(board.sideToMove()) == 0)
+    {
+        return Tablebase::Result{Outcome::Loss, 0};
+    }
+    const int slice = m_sliceOfSlot[Tablebase::slotOf(Tablebase::materialOf(board), m_maxPieces)];
+    return decodeExact(m_results[slice][Tablebase::indexOf(board)]);
+}
+
+void TablebaseGenerator::solveSlice(std::size_t slice)
+{
+    const Tablebase::Material& material = m_materials[slice];
+    const std::uint64_t size = Tablebase::sliceSize(material);
+    if (size > MAX_SLICE_SIZE)
+    {
+        throw std::length_error("tablebase slice too large");
+    }
+
+    std::vector<Exact> results(size, 0);
+    std::vector<bool> solved(size, false);
+    // Quiet moves that stay in the slice and are not yet known to lose for the mover.
+    std::vector<std::uint8_t> openMoves(size, 0);
+    std::vector<std::uint16_t> longestWin(size, 0);
+    std::vector<std::uint16_t> fastestWin(size, 0);
+    std::vector<bool> canDraw(size, false);
+    std::vector<std::vector<Pending>> queue;
+
+    auto push = [&queue](int distance, Pending pending) {
+        if (static_cast<std::size_t>(distance) >= queue.size())
+        {
+            queue.resize(distance + 1);
+        }
+        queue[distance].push_back(pending);
+    };
+
+    // Seed with everything decided by moves that leave the slice.
+    Board board;
+    Board::MoveList moves;
+    for (std::uint64_t index = 0; index < size; ++index)
+    {
+        if (!Tablebase::positionAt(material, index, board))
+        {
+            solved[index] = true;
+            continue;
+        }
+
+        board.getLegalMoves(board.sideToMove(), moves);
+        for (const auto& move : moves)
+        {
+            if (!move.isCapture && !move.promotes)
+            {
+                ++openMoves[index];
+                continue;
+            }
+
+            const Board::Undo undo = board.makeMove(move);
+            const Tablebase::Result child = resultOf(board);
+            board.unmakeMove(undo);
+            if (child.outcome == Outcome::Loss)
+            {
+                const int distance = child.distance + 1;
+                fastestWin[index] = static_cast<std::uint16_t>(fastestWin[index] == 0 ? distance : std::min<int>(fastestWin[index], distance));
+            }
+            else if (child.outcome == Outcome::Win)
+            {
+                longestWin[index] = std::max<std::uint16_t>(longestWin[index], static_cast<std::uint16_t>(child.distance));
+            }
+            else
+            {
+                canDraw[index] = true;
+            }
+        }
+
+        const auto pending = Pending{static_cast<std::uint32_t>(index), fastestWin[index] != 0};
+        if (moves.empty())
+        {
+            push(0, pending);
+        }
+        else if (fastestWin[index] != 0)
+        {
+            push(fastestWin[index], pending);
+        }
+        else if (openMoves[index] == 0 && !canDraw[index])
+        {
+            push(longestWin[index] + 1, pending);
+        }
+    }
+
+    // Settle positions in order of distance and pass each result to its predecessors.
+    for (std::size_t distance = 0; distance < queue.size(); ++distance)
+    {
+        for (std::size_t i = 0; i < queue[distance].size(); ++i)
+        {
+            const Pending pending = queue[distance][i];
+            if (solved[pending.index])
+            {
+                continue;
+            }
+            solved[pending.index] = true;
+            results[pending.index] = encodeExact({pending.win ? Outcome::Win : Outcome::Loss, static_cast<int>(distance)});
+
+            Tablebase::positionAt(material, pending.index, board);
+            forEachUnmove(board, [&](const Board& predecessor) {
+                const auto index = static_cast<std::uint32_t>(Tablebase::indexOf(predecessor));
+                if (solved[index])
+                {
+                    return;
+                }
+                if (!pending.win)
+                {
+                    if (fastestWin[index] == 0 || distance + 1 < fastestWin[index])
+                    {
+                        fastestWin[index] = static_cast<std::uint16_t>(distance + 1);
+                        push(static_cast<int>(distance + 1), Pending{index, true});
+                    }
+                    return;
+                }
+
+                --openMoves[index];
+                longestWin[index] = std::max<std::uint16_t>(longestWin[index], static_cast<std::uint16_t>(distance));
+                if (openMoves[index] == 0 && fastestWin[index] == 0 && !canDraw[index])
+                {
+                    push(longestWin[index] + 1, Pending{index, false});
+                }
+            });
+        }
+        queue[distance].clear();
+        queue[distance].shrink_to_fit();
+    }
+
+    m_results[slice] = std::move(results);
+}
+
+// Calls visit with every position whose side to move has a quiet, uncrowning
+// move leading to `board`. Captures are compulsory, so predecessors with a
+// capture available are skipped.
+template <typename Visit>
+void TablebaseGenerator::forEachUnmove(const Board& board, Visit&& visit)
+{
+    const PieceColor mover = opponent(board.sideToMove());
+    const Bitboard own = board.piecesOf(mover);
+    const Bitboard other = board.piecesOf(board.sideToMove());
+    const Bitboard occupied = own | other;
+    // Men came from one row further from their crowning row.
+    const int backward = mover == PieceColor::First ? 1 : -1;
+
+    Board predecessor;
+    for (Bitboard pieces = own; pieces; pieces &= pieces - 1)
+    {
+        const int to = std::countr_zero(pieces);
+        const Bitboard toBit = Bitboard{1} << to;
+        const bool king = (board.kings() & toBit) != 0;
+        const Square position = Board::squarePosition(to);
+
+        for (const int rowStep : {-1, 1})
+        {
+            if (!king && rowStep != backward)
+            {
+                continue;
+            }
+            for (const int colStep : {-1, 1})
+            {
+                Square from = position + Square(rowStep, colStep);
+                while (Board::isInside(from))
+                {
+                    const Bitboard fromBit = Bitboard{1} << Board::squareIndex(from);
+                    if (occupied & fromBit)
+                    {
+                        break;
+                    }
+
+                    const Bitboard moved = (own & ~toBit) | fromBit;
+                    const Bitboard kings = king ? (board.kings() & ~toBit) | fromBit : board.kings();
+                    if (mover == PieceColor::First)
+                    {
+                        predecessor.setPosition(moved, other, kings, mover);
+                    }
+                    else
+                    {
+                        predecessor.setPosition(other, moved, kings, mover);
+                    }
+                    if (!predecessor.hasCaptureMoves(mover))
+                    {
+                        visit(predecessor);
+                    }
+
+                    if (!king)
+                    {
+                        break;
+                    }
+                    from += Square(rowStep, colStep);
+                }
+            }
+        }
+    }
+}
+
+TablebaseGenerator::Exact TablebaseGenerator::encodeExact(const Tablebase::Result& result)
+{
+    switch (result.outcome)
+    {
+    case Outcome::Win:
+        return static_cast<Exact>(result.distance * 2);
+    case Outcome::Loss:
+        return static_cast<Exact>(result.distance * 2 + 1);
+    case Outcome::Draw:
+        break;
+    }
+    return 0;
+}
+
+Tablebase::Result TablebaseGenerator::decodeExact(Exact exact)
+{
+    if (exact == 0)
+    {
+        return Tablebase::Result{Outcome::Draw, 0};
+    }
+    return Tablebase::Result{exact % 2 == 0 ? Outcome::Win : Outcome::Loss, exact / 2};
+}
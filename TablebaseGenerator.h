@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Board.h"
+#include "Tablebase.h"
+
+// Builds the win/loss/draw and distance-to-win database for every position
+// with up to maxPieces pieces by retrograde analysis.
+//
+// Slices are solved smallest first: a capture leaves a slice with fewer
+// pieces and a crowning one with fewer men, so whatever a move can reach
+// outside the current slice is already solved. Inside a slice, results spread
+// backwards from the solved positions through unmoves in order of distance,
+// so every win is the fastest and every loss the slowest. Positions never
+// reached this way are draws.
+class TablebaseGenerator
+{
+public:
+    using Progress = std::function<void(const Tablebase::Material&, std::uint64_t positions)>;
+
+    explicit TablebaseGenerator(int maxPieces);
+
+    void generate(const Progress& progress = {});
+    bool write(const std::string& path) const;
+
+    // Only valid for positions covered by a generated slice, or where the side
+    // to move has no pieces left.
+    Tablebase::Result resultOf(const Board& board) const;
+
+private:
+    // Exact results while solving; encoded into Tablebase::Value only on write.
+    using Exact = std::uint16_t;
+
+    void solveSlice(std::size_t slice);
+    template <typename Visit>
+    static void forEachUnmove(const Board& board, Visit&& visit);
+
+    static Exact encodeExact(const Tablebase::Result& result);
+    static Tablebase::Result decodeExact(Exact exact);
+
+    int m_maxPieces;
+    std::vector<Tablebase::Material> m_materials; // in solving order
+    std::vector<int> m_sliceOfSlot;
+    std::vector<std::vector<Exact>> m_results;
+};
@@ -0,0 +1,178 @@
+#include "TranspositionTable.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+namespace
+{
+constexpr int AGE_BITS = 6;
+constexpr std::uint8_t AGE_MASK = (1 << AGE_BITS) - 1;
+// Stale entries rank below any entry of the current search.
+constexpr int STALE_PENALTY = 256;
+constexpr std::size_t HASHFULL_SAMPLE_BUCKETS = 250;
+
+struct Unpacked
+{
+    int score;
+    int depth;
+    TranspositionTable::Bound bound;
+    std::uint8_t age;
+    std::uint16_t move;
+};
+
+std::uint64_t pack(int score, int depth, TranspositionTable::Bound bound, std::uint8_t age, std::uint16_t move)
+{
+    return static_cast<std::uint64_t>(static_cast<std::uint16_t>(score))
+        | static_cast<std::uint64_t>(std::clamp(depth, 0, 255)) << 16
+        | static_cast<std::uint64_t>(bound) << 24
+        | static_cast<std::uint64_t>(age & AGE_MASK) << 26
+        | static_cast<std::uint64_t>(move) << 32;
+}
+
+Unpacked unpack(std::uint64_t data)
+{
+    return {static_cast<std::int16_t>(data & 0xFFFF),
+            static_cast<int>((data >> 16) & 0xFF),
+            static_cast<TranspositionTable::Bound>((data >> 24) & 0x3),
+            static_cast<std::uint8_t>((data >> 26) & AGE_MASK),
+            static_cast<std::uint16_t>((data >> 32) & 0xFFFF)};
+}
+}
+
+TranspositionTable::TranspositionTable(std::size_t megabytes)
+{
+    resize(megabytes);
+}
+
+void TranspositionTable::resize(std::size_t megabytes)
+{
+    const std::size_t requested = std::max<std::size_t>(1, megabytes * 1024 * 1024 / sizeof(Bucket));
+    // A power of two lets the low key bits pick the bucket.
+    m_bucketCount = std::bit_floor(requested);
+    m_buckets = std::make_unique<Bucket[]>(m_bucketCount);
+    m_age = 0;
+}
+
+void TranspositionTable::clear()
+{
+    for (std::size_t i = 0; i < m_bucketCount; ++i)
+    {
+        for (auto& slot : m_buckets[i].slots)
+        {
+            slot.check.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    m_age = 0;
+}
+
+void TranspositionTable::newSearch()
+{
+    m_age = static_cast<std::uint8_t>((m_age + 1) & AGE_MASK);
+}
+
+std::optional<TranspositionTable::Entry> TranspositionTable::probe(std::uint64_t key) const
+{
+    const Bucket& bucket = bucketFor(key);
+    for (const auto& slot : bucket.slots)
+    {
+        const std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+        const std::uint64_t check = slot.check.load(std::memory_order_relaxed);
+        if ((check ^ data) != key)
+        {
+            continue;
+        }
+
+        const Unpacked fields = unpack(data);
+        if (fields.bound == Bound::None)
+        {
+            continue;
+        }
+        return Entry{fields.score, fields.depth, fields.bound, fields.move};
+    }
+    return std::nullopt;
+}
+
+void TranspositionTable::store(std::uint64_t key, int depth, int score, Bound bound, std::uint16_t move)
+{
+    Bucket& bucket = bucketFor(key);
+    Slot* victim = &bucket.slots[0];
+    int victimWorth = INT32_MAX;
+
+    for (auto& slot : bucket.slots)
+    {
+        const std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+        const std::uint64_t check = slot.check.load(std::memory_order_relaxed);
+        const Unpacked fields = unpack(data);
+
+        if ((check ^ data) == key && fields.bound != Bound::None)
+        {
+            // Same position: keep a deeper result from this search unless the new one is exact.
+            if (fields.age == m_age && depth < fields.depth && bound != Bound::Exact)
+            {
+                return;
+            }
+            if (move == 0)
+            {
+                move = fields.move;
+            }
+            victim = &slot;
+            break;
+        }
+
+        const int worth = data == 0 ? -2 * STALE_PENALTY
+                                    : fields.depth - (fields.age == m_age ? 0 : STALE_PENALTY);
+        if (worth < victimWorth)
+        {
+            victimWorth = worth;
+            victim = &slot;
+        }
+    }
+
+    const std::uint64_t data = pack(score, depth, bound, m_age, move);
+    victim->data.store(data, std::memory_order_relaxed);
+    victim->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const
+{
+    const std::size_t sampled = std::min(m_bucketCount, HASHFULL_SAMPLE_BUCKETS);
+    int used = 0;
+    for (std::size_t i = 0; i < sampled; ++i)
+    {
+        for (const auto& slot : m_buckets[i].slots)
+        {
+            const std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if (data != 0 && unpack(data).age == m_age)
+            {
+                ++used;
+            }
+        }
+    }
+    return static_cast<int>(used * 1000 / (sampled * SLOTS_PER_BUCKET));
+}
+
+std::uint16_t TranspositionTable::encodeMove(const Board::Move& move)
+{
+    const int from = Board::squareIndex(move.from);
+    const int to = Board::squareIndex(move.to);
+    unsigned pathSum = move.hopCount;
+    for (int hop = 0; hop < move.hopCount; ++hop)
+    {
+        pathSum = (pathSum * 7 + move.landings[hop]) % 15;
+    }
+    // The checksum is 1..15 so an encoded move is never 0.
+    const unsigned checksum = pathSum % 15 + 1;
+    return static_cast<std::uint16_t>(((from & 0x3F) << 10) | ((to & 0x3F) << 4) | static_cast<int>(checksum));
+}
+
+const TranspositionTable::Bucket& TranspositionTable::bucketFor(std::uint64_t key) const
+{
+    return m_buckets[key & (m_bucketCount - 1)];
+}
+
+TranspositionTable::Bucket& TranspositionTable::bucketFor(std::uint64_t key)
+{
+    return m_buckets[key & (m_bucketCount - 1)];
+}
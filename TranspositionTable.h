@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include "Board.h"
+
+// Fixed-size hash table of search results shared by any number of threads
+// without locks. Each slot stores its packed data next to the key XORed with
+// that data; a torn write from a concurrent store fails the XOR check and reads
+// as a miss. Slots are grouped four to a cache line, and a bucket keeps the
+// deepest results of the current search.
+class TranspositionTable
+{
+public:
+    enum class Bound : std::uint8_t
+    {
+        None,
+        Exact,
+        Lower,
+        Upper
+    };
+
+    struct Entry
+    {
+        int score = 0;
+        int depth = 0;
+        Bound bound = Bound::None;
+        std::uint16_t move = 0;
+    };
+
+    static constexpr std::size_t DEFAULT_MEGABYTES = 16;
+
+    explicit TranspositionTable(std::size_t megabytes = DEFAULT_MEGABYTES);
+
+    void resize(std::size_t megabytes);
+    void clear();
+    // Marks older entries as replaceable; call once per search.
+    void newSearch();
+
+    std::optional<Entry> probe(std::uint64_t key) const;
+    void store(std::uint64_t key, int depth, int score, Bound bound, std::uint16_t move);
+
+    // Permille of sampled slots written during the current search.
+    int hashfull() const;
+
+    // Compact move fingerprint: from and to squares plus a path checksum.
+    // 0 means "no move".
+    static std::uint16_t encodeMove(const Board::Move& move);
+
+private:
+    struct Slot
+    {
+        std::atomic<std::uint64_t> check{0};
+        std::atomic<std::uint64_t> data{0};
+    };
+
+    static constexpr std::size_t SLOTS_PER_BUCKET = 4;
+
+    struct alignas(64) Bucket
+    {
+        Slot slots[SLOTS_PER_BUCKET];
+    };
+
+    static_assert(sizeof(Bucket) == 64, "a bucket must fill exactly one cache line");
+
+    const Bucket& bucketFor(std::uint64_t key) const;
+    Bucket& bucketFor(std::uint64_t key);
+
+    std::unique_ptr<Bucket[]> m_buckets;
+    std::size_t m_bucketCount = 0;
+    std::uint8_t m_age = 0;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "Piece.h"
+
+// Random keys for incremental position hashing, generated at compile time so
+// every build and every process agrees on them. There is one set per board
+// size, each drawn from the same sequence, so the keys of a size never change
+// when another size is added.
+namespace Zobrist
+{
+template <int Squares>
+struct Keys
+{
+    // Indexed by color (First, Second), then man/king, then square.
+    std::array<std::array<std::array<std::uint64_t, Squares>, 2>, 2> pieces{};
+    std::uint64_t secondToMove = 0;
+};
+
+constexpr std::uint64_t splitMix64(std::uint64_t& state)
+{
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+template <int Squares>
+constexpr Keys<Squares> generateKeys()
+{
+    Keys<Squares> keys;
+    std::uint64_t state = 0x5EED5EED5EED5EEDULL;
+    for (auto& color : keys.pieces)
+    {
+        for (auto& kind : color)
+        {
+            for (auto& key : kind)
+            {
+                key = splitMix64(state);
+            }
+        }
+    }
+    keys.secondToMove = splitMix64(state);
+    return keys;
+}
+
+template <int Squares>
+inline constexpr Keys<Squares> KEYS = generateKeys<Squares>();
+
+template <int Squares>
+constexpr std::uint64_t pieceKey(PieceColor color, bool king, int square)
+{
+    return KEYS<Squares>.pieces[color == PieceColor::First ? 0 : 1][king ? 1 : 0][square];
+}
+}
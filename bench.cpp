@@ -0,0 +1,371 @@
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "BatchEvaluator.h"
+#include "Board.h"
+#include "Engine.h"
+#include "Notation.h"
+#include "Stats.h"
+#include "Tablebase.h"
+
+namespace
+{
+constexpr int DEFAULT_SMP_DEPTH = 14;
+constexpr unsigned BENCH_SEED = 20240601;
+constexpr int MOVEGEN_POSITIONS = 4096;
+constexpr int MOVEGEN_PASSES = 64;
+constexpr int MOVEGEN_PERFT_DEPTH = 9;
+constexpr int EVAL_POSITIONS = 1 << 16;
+constexpr int EVAL_PASSES = 64;
+
+void printUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " smp [max-threads] [depth] [--fen FEN] [--tablebase PATH]\n"
+              << "       " << program << " movegen\n"
+              << "       " << program << " eval\n";
+}
+
+// The start position plus a few deterministic random continuations of it.
+std::vector<Board> benchPositions()
+{
+    std::vector<Board> positions;
+    std::mt19937 rng(BENCH_SEED);
+    for (int plies : {0, 6, 12, 18, 24})
+    {
+        Board board;
+        Board::MoveList moves;
+        for (int ply = 0; ply < plies; ++ply)
+        {
+            board.getLegalMoves(board.sideToMove(), moves);
+            if (moves.empty())
+            {
+                break;
+            }
+            board.applyMove(moves[rng() % moves.size()]);
+        }
+        positions.push_back(board);
+    }
+    return positions;
+}
+
+// Time to reach a fixed depth for 1, 2, 4, ... threads, from a cold table each time.
+int runSmp(int maxThreads, int depth, const std::vector<Board>& positions, const Tablebase& tablebase)
+{
+    std::cout << "threads  time_ms        nodes    nodes/sec  speedup    ebf  tt_hit%\n";
+
+    double baselineMs = 0.0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        Engine::Limits limits;
+        limits.maxDepth = depth;
+        limits.maxTime = std::chrono::hours(1);
+        limits.threads = threads;
+        Engine engine(limits, 64);
+        if (tablebase.isOpen())
+        {
+            engine.setTablebase(&tablebase);
+        }
+
+        std::uint64_t nodes = 0;
+        double ms = 0.0;
+        double branchingFactor = 0.0;
+        const Stats::Snapshot before = Stats::snapshot();
+        for (const auto& position : positions)
+        {
+            engine.clearTable();
+            const auto start = std::chrono::steady_clock::now();
+            const Engine::Result result = engine.search(position, position.sideToMove());
+            ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            nodes += result.nodes;
+            branchingFactor += result.branchingFactor / static_cast<double>(positions.size());
+        }
+        const Stats::Snapshot counted = Stats::snapshot() - before;
+        if (threads == 1)
+        {
+            baselineMs = ms;
+        }
+
+        std::cout << std::setw(7) << threads << std::setw(9) << static_cast<std::uint64_t>(ms) << std::setw(13) << nodes
+                  << std::setw(13) << static_cast<std::uint64_t>(ms > 0 ? nodes * 1000.0 / ms : 0) << std::setw(9)
+                  << std::fixed << std::setprecision(2) << (ms > 0 ? baselineMs / ms : 0.0) << std::setw(7)
+                  << branchingFactor << std::setw(9) << std::setprecision(1) << 100.0 * counted.tableHitRate() << '\n';
+    }
+    return 0;
+}
+
+// Positions from random games, so kings, captures and sparse boards all show up.
+std::vector<Board> sampledPositions(int count)
+{
+    std::vector<Board> positions;
+    std::mt19937 rng(BENCH_SEED);
+    Board board;
+    Board::MoveList moves;
+    while (static_cast<int>(positions.size()) < count)
+    {
+        board.getLegalMoves(board.sideToMove(), moves);
+        if (moves.empty())
+        {
+            board.reset();
+            continue;
+        }
+        board.applyMove(moves[rng() % moves.size()]);
+        positions.push_back(board);
+    }
+    return positions;
+}
+
+// Runs call over every position a few times and reports the mean cost of one call.
+void timeCall(const char* name, std::vector<Board>& positions, const std::function<std::uint64_t(Board&)>& call)
+{
+    std::uint64_t calls = 0;
+    std::uint64_t checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < MOVEGEN_PASSES; ++pass)
+    {
+        for (auto& position : positions)
+        {
+            checksum += call(position);
+            ++calls;
+        }
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    // The checksum keeps the calls from being optimized away.
+    std::cout << std::left << std::setw(18) << name << std::right << std::setw(10) << std::fixed
+              << std::setprecision(1) << ns / calls << " ns/call  (checksum " << checksum << ")\n";
+}
+
+std::uint64_t perft(Board& board, int depth)
+{
+    Board::MoveList moves;
+    board.getLegalMoves(board.sideToMove(), moves);
+    if (depth <= 1)
+    {
+        return moves.size();
+    }
+
+    std::uint64_t nodes = 0;
+    for (const auto& move : moves)
+    {
+        const Board::Undo undo = board.makeMove(move);
+        nodes += perft(board, depth - 1);
+        board.unmakeMove(undo);
+    }
+    return nodes;
+}
+
+// Per-call cost of the generator entry points, plus a perft nodes/sec baseline.
+int runMovegen()
+{
+    auto positions = sampledPositions(MOVEGEN_POSITIONS);
+    Board::MoveList moves;
+
+    timeCall("getMovesForPiece", positions, [&](Board& board) {
+        std::uint64_t total = 0;
+        for (int square = 0; square < Board::SQUARES; ++square)
+        {
+            const auto from = Board::squarePosition(square);
+            const auto piece = board.pieceAt(from);
+            if (piece && piece->getColor() == board.sideToMove())
+            {
+                board.getMovesForPiece(from, false, moves);
+                total += moves.size();
+            }
+        }
+        return total;
+    });
+    timeCall("getAllMoves", positions, [&](Board& board) {
+        board.getAllMoves(board.sideToMove(), false, moves);
+        return static_cast<std::uint64_t>(moves.size());
+    });
+    timeCall("getLegalMoves", positions, [&](Board& board) {
+        board.getLegalMoves(board.sideToMove(), moves);
+        return static_cast<std::uint64_t>(moves.size());
+    });
+    timeCall("hasCaptureMoves", positions, [](Board& board) {
+        return static_cast<std::uint64_t>(board.hasCaptureMoves(board.sideToMove()));
+    });
+    timeCall("playerHasMoves", positions, [](Board& board) {
+        return static_cast<std::uint64_t>(board.playerHasMoves(board.sideToMove()));
+    });
+    timeCall("makeMove+unmake", positions, [&](Board& board) {
+        board.getLegalMoves(board.sideToMove(), moves);
+        std::uint64_t hashes = 0;
+        for (const auto& move : moves)
+        {
+            const Board::Undo undo = board.makeMove(move);
+            hashes += board.hash() & 1;
+            board.unmakeMove(undo);
+        }
+        return hashes;
+    });
+    timeCall("copy+applyMove", positions, [&](Board& board) {
+        board.getLegalMoves(board.sideToMove(), moves);
+        std::uint64_t hashes = 0;
+        for (const auto& move : moves)
+        {
+            Board child = board;
+            child.applyMove(move);
+            hashes += child.hash() & 1;
+        }
+        return hashes;
+    });
+
+    Board start;
+    const auto begin = std::chrono::steady_clock::now();
+    const std::uint64_t nodes = perft(start, MOVEGEN_PERFT_DEPTH);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "perft " << MOVEGEN_PERFT_DEPTH << ": " << nodes << " nodes, "
+              << static_cast<std::uint64_t>(seconds > 0 ? nodes / seconds : 0) << " nodes/sec\n";
+    return 0;
+}
+
+void printEvalRate(std::string_view name, double ns, std::int64_t checksum)
+{
+    std::cout << std::left << std::setw(18) << name << std::right << std::setw(10) << std::fixed
+              << std::setprecision(2) << ns / (static_cast<double>(EVAL_POSITIONS) * EVAL_PASSES)
+              << " ns/position  (checksum " << checksum << ")\n";
+}
+
+// Engine::evaluate one position at a time against every batch kernel the CPU
+// supports, after checking that each kernel scores exactly like it. The
+// kernels also compute the features gamedb exports, so they are the slower.
+int runEval()
+{
+    const auto boards = sampledPositions(EVAL_POSITIONS);
+    BatchEvaluator::Positions positions;
+    positions.reserve(boards.size());
+    for (const auto& board : boards)
+    {
+        positions.add(board);
+    }
+
+    std::int64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < EVAL_PASSES; ++pass)
+    {
+        for (const auto& board : boards)
+        {
+            checksum += Engine::evaluate(board, board.sideToMove());
+        }
+    }
+    printEvalRate("Engine::evaluate",
+                  std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count(), checksum);
+
+    int failures = 0;
+    BatchEvaluator::Evaluations evaluations;
+    using Kernel = BatchEvaluator::Kernel;
+    for (const Kernel kernel : {Kernel::Scalar, Kernel::Sse42, Kernel::Avx2})
+    {
+        if (!BatchEvaluator::isSupported(kernel))
+        {
+            std::cout << std::left << std::setw(18) << BatchEvaluator::name(kernel) << "not supported\n";
+            continue;
+        }
+        const BatchEvaluator evaluator(kernel);
+        evaluator.evaluate(positions, evaluations);
+        for (std::size_t i = 0; i < boards.size(); ++i)
+        {
+            if (evaluations.scores[i] != Engine::evaluate(boards[i], boards[i].sideToMove()))
+            {
+                std::cout << BatchEvaluator::name(kernel) << ": scores " << evaluations.scores[i] << " instead of "
+                          << Engine::evaluate(boards[i], boards[i].sideToMove()) << " for position " << i << '\n';
+                ++failures;
+                break;
+            }
+        }
+
+        checksum = 0;
+        start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < EVAL_PASSES; ++pass)
+        {
+            evaluator.evaluate(positions, evaluations);
+            for (const std::int32_t score : evaluations.scores)
+            {
+                checksum += score;
+            }
+        }
+        printEvalRate(BatchEvaluator::name(kernel),
+                      std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count(),
+                      checksum);
+    }
+    return failures == 0 ? 0 : 1;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    const std::string_view mode = argv[1];
+    try
+    {
+        if (mode == "smp")
+        {
+            std::vector<std::string_view> counts;
+            std::vector<Board> positions = benchPositions();
+            Tablebase tablebase;
+            for (int i = 2; i < argc; ++i)
+            {
+                const std::string_view arg = argv[i];
+                if (arg == "--fen" && i + 1 < argc)
+                {
+                    const auto board = Notation::parseFen(argv[++i]);
+                    if (!board)
+                    {
+                        std::cerr << "Unable to read position " << argv[i] << '\n';
+                        return 1;
+                    }
+                    positions = {*board};
+                }
+                else if (arg == "--tablebase" && i + 1 < argc)
+                {
+                    if (!tablebase.open(argv[++i]))
+                    {
+                        std::cerr << "Unable to open tablebase at " << argv[i] << '\n';
+                        return 1;
+                    }
+                }
+                else
+                {
+                    counts.push_back(arg);
+                }
+            }
+            if (counts.size() > 2)
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+            const int hardwareThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            const int maxThreads = counts.size() > 0 ? std::stoi(std::string(counts[0])) : hardwareThreads;
+            const int depth = counts.size() > 1 ? std::stoi(std::string(counts[1])) : DEFAULT_SMP_DEPTH;
+            return runSmp(maxThreads, depth, positions, tablebase);
+        }
+        if (mode == "movegen")
+        {
+            return runMovegen();
+        }
+        if (mode == "eval")
+        {
+            return runEval();
+        }
+    }
+    catch (const std::exception&)
+    {
+    }
+
+    printUsage(argv[0]);
+    return 1;
+}
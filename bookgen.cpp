@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Board.h"
+#include "Engine.h"
+#include "Notation.h"
+#include "OpeningBook.h"
+
+namespace
+{
+constexpr char DEFAULT_PATH[] = "checkers.book";
+constexpr int DEFAULT_GAMES = 200;
+constexpr int DEFAULT_PLIES = 12;
+constexpr int DEFAULT_THINK_MS = 200;
+constexpr int DEFAULT_DEPTH = 8;
+// Self-play picks among moves scoring within this much of the best one.
+constexpr int DEFAULT_MARGIN = 25;
+constexpr unsigned DEFAULT_SEED = 20240601;
+constexpr int MAX_FORCED_PLIES = 32;
+
+struct Options
+{
+    std::string out = DEFAULT_PATH;
+    std::string input;
+    std::string fen;
+    int games = DEFAULT_GAMES;
+    int plies = DEFAULT_PLIES;
+    int thinkMs = DEFAULT_THINK_MS;
+    int margin = DEFAULT_MARGIN;
+    unsigned seed = DEFAULT_SEED;
+};
+
+void printUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " selfplay [--games N] [--plies N] [--think-ms N] [--margin N] [--seed N] [--out PATH]\n"
+              << "       " << program << " games FILE [--plies N] [--out PATH]\n"
+              << "       " << program << " show BOOK [--fen FEN]\n";
+}
+
+// Search score from the side to move, playing through forced moves, which
+// the engine returns without searching.
+int scoreFor(Engine& engine, Board board)
+{
+    int sign = 1;
+    for (int ply = 0; ply < MAX_FORCED_PLIES; ++ply)
+    {
+        const Engine::Result result = engine.search(board, board.sideToMove());
+        if (!result.bestMove || result.depth > 0)
+        {
+            return sign * result.score;
+        }
+        board.applyMove(*result.bestMove);
+        sign = -sign;
+    }
+    return 0;
+}
+
+int writeBook(const OpeningBookBuilder& builder, const std::string& path)
+{
+    if (!builder.write(path))
+    {
+        std::cerr << "Unable to write " << path << '\n';
+        return 1;
+    }
+    std::cout << "wrote " << path << ": " << builder.positions() << " positions\n";
+    return 0;
+}
+
+// Engine self-play from the start position. Every ply searches each legal
+// move and plays one at random among those close to the best, so the book
+// covers several sound lines instead of a single one.
+int buildFromSelfPlay(const Options& options)
+{
+    Engine::Limits limits;
+    limits.maxDepth = DEFAULT_DEPTH;
+    limits.maxTime = std::chrono::milliseconds(options.thinkMs);
+    Engine engine(limits);
+    std::mt19937 random(options.seed);
+    OpeningBookBuilder builder;
+
+    for (int game = 0; game < options.games; ++game)
+    {
+        Board board;
+        Board::MoveList moves;
+        for (int ply = 0; ply < options.plies; ++ply)
+        {
+            board.getLegalMoves(board.sideToMove(), moves);
+            if (moves.empty())
+            {
+                break;
+            }
+
+            std::vector<int> scores;
+            for (const auto& move : moves)
+            {
+                Board child = board;
+                child.applyMove(move);
+                scores.push_back(-scoreFor(engine, child));
+            }
+            const int best = *std::max_element(scores.begin(), scores.end());
+            std::vector<std::size_t> good;
+            for (std::size_t i = 0; i < scores.size(); ++i)
+            {
+                if (scores[i] >= best - options.margin)
+                {
+                    good.push_back(i);
+                }
+            }
+
+            const Board::Move chosen = moves[good[random() % good.size()]];
+            builder.add(board, chosen);
+            board.applyMove(chosen);
+        }
+        std::cout << "game " << game + 1 << '/' << options.games << ", " << builder.positions() << " positions\n";
+    }
+    return writeBook(builder, options.out);
+}
+
+// One game per line in standard notation; move numbers and results are skipped.
+int buildFromGames(const Options& options)
+{
+    std::ifstream in(options.input);
+    if (!in)
+    {
+        std::cerr << "Unable to read " << options.input << '\n';
+        return 1;
+    }
+
+    OpeningBookBuilder builder;
+    int games = 0;
+    int rejected = 0;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        const auto tokens = Notation::splitMoves(line);
+        Board board;
+        for (std::size_t ply = 0; ply < tokens.size() && ply < static_cast<std::size_t>(options.plies); ++ply)
+        {
+            const auto move = Notation::parseMove(board, tokens[ply]);
+            if (!move)
+            {
+                ++rejected;
+                break;
+            }
+            builder.add(board, *move);
+            board.applyMove(*move);
+        }
+        games += tokens.empty() ? 0 : 1;
+    }
+
+    std::cout << games << " games read";
+    if (rejected > 0)
+    {
+        std::cout << ", " << rejected << " cut short at an illegal move";
+    }
+    std::cout << '\n';
+    return writeBook(builder, options.out);
+}
+
+int show(const std::string& path, const std::string& fen)
+{
+    OpeningBook book;
+    if (!book.open(path))
+    {
+        std::cerr << "Unable to open " << path << '\n';
+        return 1;
+    }
+    const auto board = fen.empty() ? std::optional<Board>(Board{}) : Notation::parseFen(fen);
+    if (!board)
+    {
+        std::cerr << "Invalid FEN\n";
+        return 1;
+    }
+
+    const auto candidates = book.candidates(*board);
+    int total = 0;
+    for (const auto& candidate : candidates)
+    {
+        total += candidate.weight;
+    }
+    std::cout << book.size() << " entries; " << candidates.size() << " book moves for " << Notation::toFen(*board) << '\n';
+    for (const auto& candidate : candidates)
+    {
+        std::cout << Notation::toString(candidate.move) << "  weight " << candidate.weight << "  ("
+                  << candidate.weight * 100 / total << "%)\n";
+    }
+    return 0;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    const std::string_view mode = argv[1];
+    Options options;
+    int next = 2;
+    if ((mode == "games" || mode == "show") && argc > 2)
+    {
+        options.input = argv[next++];
+    }
+
+    try
+    {
+        for (int i = next; i < argc; ++i)
+        {
+            const std::string_view arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+            const std::string value = argv[++i];
+            if (arg == "--out")
+            {
+                options.out = value;
+            }
+            else if (arg == "--fen")
+            {
+                options.fen = value;
+            }
+            else if (arg == "--games")
+            {
+                options.games = std::stoi(value);
+            }
+            else if (arg == "--plies")
+            {
+                options.plies = std::stoi(value);
+            }
+            else if (arg == "--think-ms")
+            {
+                options.thinkMs = std::stoi(value);
+            }
+            else if (arg == "--margin")
+            {
+                options.margin = std::stoi(value);
+            }
+            else if (arg == "--seed")
+            {
+                options.seed = static_cast<unsigned>(std::stoul(value));
+            }
+            else
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+    }
+    catch (const std::exception&)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (mode == "selfplay")
+    {
+        return buildFromSelfPlay(options);
+    }
+    if (mode == "games" && !options.input.empty())
+    {
+        return buildFromGames(options);
+    }
+    if (mode == "show" && !options.input.empty())
+    {
+        return show(options.input, options.fen);
+    }
+    printUsage(argv[0]);
+    return 1;
+}
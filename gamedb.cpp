@@ -0,0 +1,381 @@
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "BatchEvaluator.h"
+#include "Board.h"
+#include "Notation.h"
+#include "Pdn.h"
+#include "PositionIndex.h"
+
+namespace
+{
+constexpr char INDEX_SUFFIX[] = ".idx";
+constexpr char FEATURES_SUFFIX[] = ".features.csv";
+constexpr std::size_t BYTES_PER_MEGABYTE = std::size_t{1} << 20;
+constexpr std::size_t DEFAULT_MEMORY_MEGABYTES = 256;
+// Positions evaluated per call of the batch evaluator.
+constexpr std::size_t FEATURE_BATCH = 4096;
+
+struct Options
+{
+    std::string input;
+    std::string index;
+    std::string output;
+    std::string fen;
+    std::string moves;
+    std::size_t memoryMegabytes = DEFAULT_MEMORY_MEGABYTES;
+};
+
+void printUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " stats GAMES.pdn\n"
+              << "       " << program << " index GAMES.pdn [--index PATH] [--memory MB]\n"
+              << "       " << program << " find GAMES.pdn [--index PATH] [--fen FEN | --moves \"11-15 23-19 ...\"]\n"
+              << "       " << program << " features GAMES.pdn [--out PATH]\n";
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void printRate(std::uint64_t bytes, double seconds)
+{
+    std::cout << " in " << seconds << " s";
+    if (seconds > 0)
+    {
+        std::cout << " (" << static_cast<double>(bytes) / BYTES_PER_MEGABYTE / seconds << " MB/s)";
+    }
+    std::cout << '\n';
+}
+
+// Replays every game, which is what indexing costs minus the sorting.
+int stats(const Options& options)
+{
+    Pdn::Reader reader;
+    if (!reader.open(options.input))
+    {
+        std::cerr << "Unable to read " << options.input << '\n';
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    Pdn::GameRecord game;
+    std::uint64_t games = 0;
+    std::uint64_t positions = 0;
+    std::uint64_t rejected = 0;
+    while (reader.next(game))
+    {
+        ++games;
+        rejected += Pdn::replay(game, [&positions](const Board&) { ++positions; }) ? 0 : 1;
+    }
+
+    std::cout << games << " games, " << positions << " positions";
+    if (rejected > 0)
+    {
+        std::cout << ", " << rejected << " cut short at an unreadable move";
+    }
+    printRate(reader.size(), secondsSince(start));
+    return 0;
+}
+
+int index(const Options& options)
+{
+    Pdn::Reader reader;
+    if (!reader.open(options.input))
+    {
+        std::cerr << "Unable to read " << options.input << '\n';
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    PositionIndexBuilder builder(options.index, options.memoryMegabytes * BYTES_PER_MEGABYTE / PositionIndexBuilder::ENTRY_BYTES);
+    Pdn::GameRecord game;
+    std::uint64_t games = 0;
+    bool ok = true;
+    while (ok && reader.next(game))
+    {
+        ++games;
+        Pdn::replay(game, [&](const Board& board) { ok = ok && builder.add(board.hash(), game.offset); });
+    }
+    const auto written = ok ? builder.write(reader.size()) : std::nullopt;
+    if (!written)
+    {
+        std::cerr << "Unable to write " << options.index << '\n';
+        return 1;
+    }
+
+    std::cout << "wrote " << options.index << ": " << games << " games, " << *written << " entries";
+    printRate(reader.size(), secondsSince(start));
+    return 0;
+}
+
+bool samePosition(const Board& a, const Board& b)
+{
+    return a.sideToMove() == b.sideToMove() && a.piecesOf(PieceColor::First) == b.piecesOf(PieceColor::First)
+        && a.piecesOf(PieceColor::Second) == b.piecesOf(PieceColor::Second) && a.kings() == b.kings();
+}
+
+std::optional<Board> targetPosition(const Options& options)
+{
+    if (!options.fen.empty())
+    {
+        return Notation::parseFen(options.fen);
+    }
+    Board board;
+    for (const auto& text : Notation::splitMoves(options.moves))
+    {
+        const auto move = Notation::parseMove(board, text);
+        if (!move)
+        {
+            return std::nullopt;
+        }
+        board.applyMove(*move);
+    }
+    return board;
+}
+
+int find(const Options& options)
+{
+    const std::optional<Board> target = targetPosition(options);
+    if (!target)
+    {
+        std::cerr << "Invalid position\n";
+        return 1;
+    }
+
+    PositionIndex index;
+    Pdn::Reader reader;
+    if (!index.open(options.index))
+    {
+        std::cerr << "Unable to open index " << options.index << '\n';
+        return 1;
+    }
+    if (!reader.open(options.input))
+    {
+        std::cerr << "Unable to read " << options.input << '\n';
+        return 1;
+    }
+    if (index.sourceSize() != reader.size())
+    {
+        std::cerr << "Warning: " << options.index << " was built from a different version of " << options.input
+                  << "; rebuild it with \"index\".\n";
+    }
+
+    // Each candidate is replayed, which also weeds out hash collisions.
+    Pdn::GameRecord game;
+    int found = 0;
+    for (const std::uint64_t offset : index.find(*target))
+    {
+        if (!reader.seek(offset) || !reader.next(game))
+        {
+            continue;
+        }
+        bool reached = false;
+        Pdn::replay(game, [&](const Board& board) { reached = reached || samePosition(board, *target); });
+        if (!reached)
+        {
+            continue;
+        }
+
+        ++found;
+        std::cout << "@" << offset << "  " << game.tag("Black") << " - " << game.tag("White") << "  "
+                  << (game.result.empty() ? Pdn::UNFINISHED : game.result) << "  " << game.moves.size() << " plies";
+        if (const std::string_view event = game.tag("Event"); !event.empty())
+        {
+            std::cout << "  (" << event << ')';
+        }
+        std::cout << '\n';
+    }
+    std::cout << found << " games reach " << Notation::toFen(*target) << '\n';
+    return 0;
+}
+
+// The game's result for the side to move: 1 for a win, 0 for a loss, 0.5 for
+// a draw; nothing for an unfinished game.
+std::optional<double> outcomeFor(std::string_view result, PieceColor toMove)
+{
+    if (result == Pdn::DRAW)
+    {
+        return 0.5;
+    }
+    if (result == Pdn::FIRST_WINS || result == Pdn::SECOND_WINS)
+    {
+        return (result == Pdn::FIRST_WINS) == (toMove == PieceColor::First) ? 1.0 : 0.0;
+    }
+    return std::nullopt;
+}
+
+// Writes the evaluation features of every position of every finished game,
+// one CSV row each, labelled with how the game ended: a data set for tuning
+// the evaluation weights.
+int features(const Options& options)
+{
+    Pdn::Reader reader;
+    if (!reader.open(options.input))
+    {
+        std::cerr << "Unable to read " << options.input << '\n';
+        return 1;
+    }
+    std::ofstream out(options.output);
+    if (!out)
+    {
+        std::cerr << "Unable to write " << options.output << '\n';
+        return 1;
+    }
+
+    out << "offset,outcome,score";
+    for (std::size_t i = 0; i < BatchEvaluator::FEATURES; ++i)
+    {
+        out << ',' << BatchEvaluator::name(static_cast<BatchEvaluator::Feature>(i));
+    }
+    out << '\n';
+
+    const auto start = std::chrono::steady_clock::now();
+    const BatchEvaluator evaluator;
+    BatchEvaluator::Positions positions;
+    BatchEvaluator::Evaluations evaluations;
+    std::vector<std::uint64_t> offsets;
+    std::vector<double> outcomes;
+    positions.reserve(FEATURE_BATCH);
+    std::uint64_t written = 0;
+
+    const auto flush = [&] {
+        evaluator.evaluate(positions, evaluations);
+        for (std::size_t i = 0; i < positions.size(); ++i)
+        {
+            out << offsets[i] << ',' << outcomes[i] << ',' << evaluations.scores[i];
+            for (const auto& values : evaluations.features)
+            {
+                out << ',' << values[i];
+            }
+            out << '\n';
+        }
+        written += positions.size();
+        positions.clear();
+        offsets.clear();
+        outcomes.clear();
+    };
+
+    Pdn::GameRecord game;
+    std::uint64_t games = 0;
+    std::uint64_t unfinished = 0;
+    while (reader.next(game))
+    {
+        ++games;
+        if (!outcomeFor(game.result, PieceColor::First))
+        {
+            ++unfinished;
+            continue;
+        }
+        Pdn::replay(game, [&](const Board& board) {
+            positions.add(board);
+            offsets.push_back(game.offset);
+            outcomes.push_back(*outcomeFor(game.result, board.sideToMove()));
+            if (positions.size() == FEATURE_BATCH)
+            {
+                flush();
+            }
+        });
+    }
+    flush();
+    if (!out.flush())
+    {
+        std::cerr << "Unable to write " << options.output << '\n';
+        return 1;
+    }
+
+    std::cout << "wrote " << options.output << ": " << written << " positions from " << games - unfinished
+              << " games (" << BatchEvaluator::name(evaluator.kernel()) << ')';
+    if (unfinished > 0)
+    {
+        std::cout << ", " << unfinished << " unfinished games skipped";
+    }
+    printRate(reader.size(), secondsSince(start));
+    return 0;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    const std::string_view mode = argv[1];
+    Options options;
+    options.input = argv[2];
+    options.index = options.input + INDEX_SUFFIX;
+    options.output = options.input + FEATURES_SUFFIX;
+
+    try
+    {
+        for (int i = 3; i < argc; ++i)
+        {
+            const std::string_view arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+            const std::string value = argv[++i];
+            if (arg == "--index")
+            {
+                options.index = value;
+            }
+            else if (arg == "--out")
+            {
+                options.output = value;
+            }
+            else if (arg == "--fen")
+            {
+                options.fen = value;
+            }
+            else if (arg == "--moves")
+            {
+                options.moves = value;
+            }
+            else if (arg == "--memory")
+            {
+                options.memoryMegabytes = std::stoul(value);
+            }
+            else
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+    }
+    catch (const std::exception&)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (mode == "stats")
+    {
+        return stats(options);
+    }
+    if (mode == "index")
+    {
+        return index(options);
+    }
+    if (mode == "find")
+    {
+        return find(options);
+    }
+    if (mode == "features")
+    {
+        return features(options);
+    }
+    printUsage(argv[0]);
+    return 1;
+}
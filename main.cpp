@@ -1,8 +1,85 @@
 #include "Game.h"
 
-int main()
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace
+{
+void printUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [--computer first|second|both] [--think-ms N] [--depth N] [--threads N]\n"
+              << "       [--tablebase PATH] [--book PATH] [--record PATH] [--trace PATH]\n"
+              << "       [--ponder on|off]\n";
+}
+}
+
+int main(int argc, char* argv[])
 {
-    Game game;
+    GameOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        const std::string value = argv[++i];
+        try
+        {
+            if (arg == "--computer" && (value == "first" || value == "second" || value == "both"))
+            {
+                options.computerFirst = value == "first" || value == "both";
+                options.computerSecond = value == "second" || value == "both";
+            }
+            else if (arg == "--think-ms")
+            {
+                options.engineLimits.maxTime = std::chrono::milliseconds(std::stoi(value));
+            }
+            else if (arg == "--depth")
+            {
+                options.engineLimits.maxDepth = std::stoi(value);
+            }
+            else if (arg == "--threads")
+            {
+                options.engineLimits.threads = std::stoi(value);
+            }
+            else if (arg == "--tablebase")
+            {
+                options.tablebasePath = value;
+            }
+            else if (arg == "--book")
+            {
+                options.bookPath = value;
+            }
+            else if (arg == "--record")
+            {
+                options.recordPath = value;
+            }
+            else if (arg == "--trace")
+            {
+                options.tracePath = value;
+            }
+            else if (arg == "--ponder" && (value == "on" || value == "off"))
+            {
+                options.ponder = value == "on";
+            }
+            else
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        catch (const std::exception&)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    Game game(options);
     game.run();
     return 0;
 }
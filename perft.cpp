@@ -0,0 +1,336 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Board.h"
+#include "Notation.h"
+
+namespace
+{
+constexpr char START_FEN[] = "B:W21-32:B1-12";
+
+struct Reference
+{
+    const char* fen;
+    int depth;
+    std::uint64_t nodes;
+};
+
+// Depths 1-7 from the start position are the published English draughts
+// counts; no king can appear that early, so the rule differences (flying
+// kings, crowning mid-capture) do not show yet. The rest were cross-checked
+// against an independent hop-by-hop generator built from the original rules.
+constexpr Reference REFERENCES[] = {
+    {START_FEN, 1, 7},
+    {START_FEN, 2, 49},
+    {START_FEN, 3, 302},
+    {START_FEN, 4, 1469},
+    {START_FEN, 5, 7361},
+    {START_FEN, 6, 36768},
+    {START_FEN, 7, 179740},
+    {START_FEN, 8, 846019},
+    {START_FEN, 9, 3964406},
+    {"W:WK3,K12,16,19:B6,K22,25,K29", 4, 1900},
+    {"W:WK3,K12,16,19:B6,K22,25,K29", 6, 100038},
+    {"B:W6,7,K9,10,14,K18,20:B23,K25,26,28,30,K31", 4, 1909},
+    {"B:W6,7,K9,10,14,K18,20:B23,K25,26,28,30,K31", 6, 141680},
+    // More capture sequences than the move list holds inline; checked against
+    // an independent enumeration of the captures.
+    {"B:W1,K9,K10,K11,K17,18,K19,21,25,26,27,K32:BK2,K3,K4,K14,K30", 1, 165},
+};
+
+// Counts for the other rule sets; the start position ones are the published
+// perft figures for those games. Kings appear from depth 7 in Russian draughts, so the deeper
+// counts there also exercise flying kings that must land to keep capturing.
+struct VariantReference
+{
+    std::string_view variant;
+    const char* fen; // null for the start position
+    int depth;
+    std::uint64_t nodes;
+};
+
+constexpr VariantReference VARIANT_REFERENCES[] = {
+    {"english", nullptr, 6, 36768},
+    {"english", nullptr, 8, 845931},
+    {"english", nullptr, 10, 18391564},
+    {"russian", nullptr, 6, 37986},
+    {"russian", nullptr, 8, 929905},
+    {"russian", nullptr, 9, 4570667},
+    {"international", nullptr, 6, 167140},
+    {"international", nullptr, 8, 6483961},
+    // The start position as standard PDN writes it, so the numbering and colours stay standard.
+    {"international", "W:W31-50:B1-20", 6, 167140},
+    // Three flying kings with several hundred capture sequences, cut to the
+    // four longest by the maximum-capture rule; cross-checked against an
+    // independent generator.
+    {"international", "W:WK13,K37,K48:B7,9,10,11,14,19,20,21,29,30,31,32,39,40,41,42", 1, 4},
+    {"international", "W:WK13,K37,K48:B7,9,10,11,14,19,20,21,29,30,31,32,39,40,41,42", 3, 142},
+};
+
+void printUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [--variant house|english|russian|international] [--fen FEN] [--threads N]\n"
+              << "       [--divide] DEPTH\n"
+              << "       " << program << " --verify [--threads N]\n";
+}
+
+// Calls `run` with a board of the named rule set, set to its start position.
+template <typename Run>
+bool withVariant(std::string_view variant, Run&& run)
+{
+    if (variant == "house")
+    {
+        run(Board());
+    }
+    else if (variant == "english")
+    {
+        run(EnglishBoard());
+    }
+    else if (variant == "russian")
+    {
+        run(RussianBoard());
+    }
+    else if (variant == "international")
+    {
+        run(InternationalBoard());
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+// Same text as Notation::toString, numbered as in BoardType's FENs.
+template <typename BoardType>
+std::string moveText(const typename BoardType::Move& move)
+{
+    const auto number = [](int square) { return std::to_string(Notation::squareNumberAs<BoardType>(square)); };
+    std::string text = number(BoardType::squareIndex(move.from));
+    if (move.hopCount == 0)
+    {
+        return text + '-' + number(BoardType::squareIndex(move.to));
+    }
+    for (int hop = 0; hop < move.hopCount; ++hop)
+    {
+        text += 'x' + number(move.landings[hop]);
+    }
+    return text;
+}
+
+template <typename BoardType>
+std::uint64_t perft(BoardType& board, int depth)
+{
+    if (depth == 0)
+    {
+        return 1;
+    }
+
+    typename BoardType::MoveList moves;
+    board.getLegalMoves(board.sideToMove(), moves);
+    // Bulk-count the last ply instead of making every leaf move.
+    if (depth == 1)
+    {
+        return moves.size();
+    }
+
+    std::uint64_t nodes = 0;
+    for (const auto& move : moves)
+    {
+        const auto undo = board.makeMove(move);
+        nodes += perft(board, depth - 1);
+        board.unmakeMove(undo);
+    }
+    return nodes;
+}
+
+// Counts below every root move; threads take root moves from a shared counter.
+template <typename BoardType>
+std::vector<std::uint64_t> perftRootMoves(const BoardType& board,
+                                          const typename BoardType::MoveList& moves,
+                                          int depth,
+                                          int threads)
+{
+    std::vector<std::uint64_t> counts(moves.size(), 0);
+    std::atomic<std::size_t> next{0};
+
+    auto work = [&] {
+        BoardType local = board;
+        for (std::size_t i = next++; i < moves.size(); i = next++)
+        {
+            const auto undo = local.makeMove(moves[i]);
+            counts[i] = perft(local, depth - 1);
+            local.unmakeMove(undo);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; ++i)
+    {
+        pool.emplace_back(work);
+    }
+    work();
+    for (auto& thread : pool)
+    {
+        thread.join();
+    }
+    return counts;
+}
+
+template <typename BoardType>
+std::uint64_t runPerft(const BoardType& board, int depth, int threads, bool divide)
+{
+    if (depth == 0)
+    {
+        return 1;
+    }
+
+    typename BoardType::MoveList moves;
+    board.getLegalMoves(board.sideToMove(), moves);
+    const auto counts = perftRootMoves(board, moves, depth, threads);
+
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < moves.size(); ++i)
+    {
+        if (divide)
+        {
+            std::cout << moveText<BoardType>(moves[i]) << ": " << counts[i] << '\n';
+        }
+        total += counts[i];
+    }
+    return total;
+}
+
+// Counts from `fen`, or from the start position when it is null, under the
+// named rules; empty if either cannot be read.
+std::optional<std::uint64_t> variantPerft(std::string_view variant, const char* fen, int depth, int threads, bool divide)
+{
+    std::optional<std::uint64_t> nodes;
+    withVariant(variant, [&](auto board) {
+        if (fen)
+        {
+            const auto parsed = Notation::parseFenAs<decltype(board)>(fen);
+            if (!parsed)
+            {
+                return;
+            }
+            board = *parsed;
+        }
+        nodes = runPerft(board, depth, threads, divide);
+    });
+    return nodes;
+}
+
+int verify(int threads)
+{
+    int failures = 0;
+    for (const auto& reference : REFERENCES)
+    {
+        const auto board = Notation::parseFen(reference.fen);
+        const std::uint64_t nodes = board ? runPerft(*board, reference.depth, threads, false) : 0;
+        const bool ok = nodes == reference.nodes;
+        failures += ok ? 0 : 1;
+        std::cout << (ok ? "ok   " : "FAIL ") << reference.fen << " depth " << reference.depth << ": " << nodes;
+        if (!ok)
+        {
+            std::cout << " (expected " << reference.nodes << ')';
+        }
+        std::cout << '\n';
+    }
+    for (const auto& reference : VARIANT_REFERENCES)
+    {
+        const std::uint64_t nodes =
+            variantPerft(reference.variant, reference.fen, reference.depth, threads, false).value_or(0);
+        const bool ok = nodes == reference.nodes;
+        failures += ok ? 0 : 1;
+        std::cout << (ok ? "ok   " : "FAIL ") << reference.variant << ' ' << (reference.fen ? reference.fen : "start")
+                  << " depth " << reference.depth << ": " << nodes;
+        if (!ok)
+        {
+            std::cout << " (expected " << reference.nodes << ')';
+        }
+        std::cout << '\n';
+    }
+    std::cout << (failures == 0 ? "all perft counts match\n" : "perft mismatches found\n");
+    return failures == 0 ? 0 : 1;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    std::optional<std::string> fen;
+    std::string variant = "house";
+    int threads = 1;
+    bool divide = false;
+    bool verifyMode = false;
+    std::optional<int> depth;
+
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view arg = argv[i];
+            if (arg == "--fen" && i + 1 < argc)
+            {
+                fen = argv[++i];
+            }
+            else if (arg == "--variant" && i + 1 < argc)
+            {
+                variant = argv[++i];
+            }
+            else if (arg == "--threads" && i + 1 < argc)
+            {
+                threads = std::max(1, std::stoi(argv[++i]));
+            }
+            else if (arg == "--divide")
+            {
+                divide = true;
+            }
+            else if (arg == "--verify")
+            {
+                verifyMode = true;
+            }
+            else
+            {
+                depth = std::stoi(std::string(arg));
+            }
+        }
+    }
+    catch (const std::exception&)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (verifyMode)
+    {
+        return verify(threads);
+    }
+
+    if (!depth || *depth < 0)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto counted = variantPerft(variant, fen ? fen->c_str() : nullptr, *depth, threads, divide);
+    if (!counted)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    const std::uint64_t nodes = *counted;
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "nodes " << nodes << "  time " << static_cast<std::uint64_t>(seconds * 1000.0) << " ms  nodes/sec "
+              << static_cast<std::uint64_t>(seconds > 0 ? nodes / seconds : 0) << '\n';
+    return 0;
+}
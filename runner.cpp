@@ -0,0 +1,426 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Board.h"
+#include "Engine.h"
+#include "Notation.h"
+#include "OpeningBook.h"
+#include "Pdn.h"
+#include "Player.h"
+#include "Stats.h"
+#include "Tablebase.h"
+
+namespace
+{
+constexpr char DEFAULT_OUTPUT[] = "results.csv";
+constexpr std::uint64_t DEFAULT_GAMES = 1000;
+constexpr int DEFAULT_THINK_MS = 10;
+constexpr int DEFAULT_DEPTH = 6;
+// Kings can chase each other forever; games this long are scored as draws.
+constexpr int DEFAULT_MAX_PLIES = 200;
+constexpr std::size_t DEFAULT_HASH_MEGABYTES = 4;
+constexpr std::uint32_t DEFAULT_SEED = 20240601;
+constexpr int DEFAULT_STATS_INTERVAL_MS = 1000;
+
+enum class Outcome
+{
+    FirstWins,
+    SecondWins,
+    Draw
+};
+
+struct Options
+{
+    std::uint64_t games = DEFAULT_GAMES;
+    std::string first = "engine";
+    std::string second = "random";
+    int thinkMs = DEFAULT_THINK_MS;
+    int depth = DEFAULT_DEPTH;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    int maxPlies = DEFAULT_MAX_PLIES;
+    std::size_t hashMegabytes = DEFAULT_HASH_MEGABYTES;
+    std::uint32_t seed = DEFAULT_SEED;
+    std::string scriptPath;
+    std::string bookPath;
+    std::string tablebasePath;
+    std::string output = DEFAULT_OUTPUT;
+    std::string pdnPath; // empty for none
+    std::string statsPath; // empty for none
+    Stats::Format statsFormat = Stats::Format::Json;
+    int statsIntervalMs = DEFAULT_STATS_INTERVAL_MS;
+};
+
+// Read-only data shared by every worker thread.
+struct Shared
+{
+    std::vector<std::vector<std::string>> script;
+    OpeningBook book;
+    Tablebase tablebase;
+};
+
+struct Tally
+{
+    std::uint64_t games = 0;
+    std::uint64_t firstWins = 0;
+    std::uint64_t secondWins = 0;
+    std::uint64_t draws = 0;
+    std::uint64_t plies = 0;
+};
+
+void printUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [--games N] [--first random|engine|scripted] [--second random|engine|scripted]\n"
+              << "       [--think-ms N] [--depth N] [--threads N] [--max-plies N] [--hash MB] [--seed N]\n"
+              << "       [--script FILE] [--book PATH] [--tablebase PATH] [--out PATH] [--pdn PATH]\n"
+              << "       [--stats PATH] [--stats-format json|csv] [--stats-interval-ms N]\n";
+}
+
+bool isPlayerKind(std::string_view kind)
+{
+    return kind == "random" || kind == "engine" || kind == "scripted";
+}
+
+std::unique_ptr<Player> makePlayer(std::string_view kind, const Options& options, const Shared& shared, std::uint32_t seed)
+{
+    if (kind == "random")
+    {
+        return std::make_unique<RandomPlayer>(seed);
+    }
+    if (kind == "scripted")
+    {
+        return std::make_unique<ScriptedPlayer>(shared.script);
+    }
+
+    Engine::Limits limits;
+    limits.maxDepth = options.depth;
+    limits.maxTime = std::chrono::milliseconds(options.thinkMs);
+    // Games run in parallel, so each search stays on one thread.
+    limits.threads = 1;
+    auto player = std::make_unique<EnginePlayer>(limits, options.hashMegabytes);
+    if (shared.book.isOpen())
+    {
+        player->engine().setOpeningBook(&shared.book);
+    }
+    if (shared.tablebase.isOpen())
+    {
+        player->engine().setTablebase(&shared.tablebase);
+    }
+    return player;
+}
+
+const char* outcomeName(Outcome outcome)
+{
+    switch (outcome)
+    {
+    case Outcome::FirstWins:
+        return "first";
+    case Outcome::SecondWins:
+        return "second";
+    case Outcome::Draw:
+        break;
+    }
+    return "draw";
+}
+
+std::string_view pdnResult(Outcome outcome)
+{
+    switch (outcome)
+    {
+    case Outcome::FirstWins:
+        return Pdn::FIRST_WINS;
+    case Outcome::SecondWins:
+        return Pdn::SECOND_WINS;
+    case Outcome::Draw:
+        break;
+    }
+    return Pdn::DRAW;
+}
+
+Outcome playGame(Player& first, Player& second, int maxPlies, std::vector<Board::Move>& history, std::string& record, int& plies)
+{
+    Board board;
+    Board::MoveList moves;
+    history.clear();
+    record.clear();
+    for (plies = 0; plies < maxPlies; ++plies)
+    {
+        const PieceColor toMove = board.sideToMove();
+        board.getLegalMoves(toMove, moves);
+        if (moves.empty())
+        {
+            return toMove == PieceColor::First ? Outcome::SecondWins : Outcome::FirstWins;
+        }
+
+        Player& player = toMove == PieceColor::First ? first : second;
+        const Board::Move move = player.chooseMove(board, moves, plies);
+        if (!record.empty())
+        {
+            record += ' ';
+        }
+        record += Notation::toString(move);
+        history.push_back(move);
+        board.applyMove(move);
+    }
+    return Outcome::Draw;
+}
+
+bool loadScript(const std::string& path, std::vector<std::vector<std::string>>& script)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line))
+    {
+        auto moves = Notation::splitMoves(line);
+        if (!moves.empty())
+        {
+            script.push_back(std::move(moves));
+        }
+    }
+    return true;
+}
+
+int run(const Options& options)
+{
+    Shared shared;
+    if (!options.scriptPath.empty() && !loadScript(options.scriptPath, shared.script))
+    {
+        std::cerr << "Unable to read " << options.scriptPath << '\n';
+        return 1;
+    }
+    if (!options.bookPath.empty() && !shared.book.open(options.bookPath))
+    {
+        std::cerr << "Unable to open opening book at " << options.bookPath << '\n';
+        return 1;
+    }
+    if (!options.tablebasePath.empty() && !shared.tablebase.open(options.tablebasePath))
+    {
+        std::cerr << "Unable to open tablebase at " << options.tablebasePath << '\n';
+        return 1;
+    }
+
+    std::ofstream out(options.output, std::ios::trunc);
+    if (!out)
+    {
+        std::cerr << "Unable to write " << options.output << '\n';
+        return 1;
+    }
+    out << "game,first,second,result,plies,moves\n";
+
+    std::ofstream pdn;
+    if (!options.pdnPath.empty())
+    {
+        pdn.open(options.pdnPath, std::ios::trunc);
+        if (!pdn)
+        {
+            std::cerr << "Unable to write " << options.pdnPath << '\n';
+            return 1;
+        }
+    }
+    const Board startPosition;
+
+    // Counter lines every interval while the games run, then the totals.
+    std::ofstream statsOut;
+    std::optional<Stats::Reporter> reporter;
+    if (!options.statsPath.empty())
+    {
+        statsOut.open(options.statsPath, std::ios::trunc);
+        if (!statsOut)
+        {
+            std::cerr << "Unable to write " << options.statsPath << '\n';
+            return 1;
+        }
+        reporter.emplace(statsOut, options.statsFormat, std::chrono::milliseconds(options.statsIntervalMs));
+    }
+
+    std::atomic<std::uint64_t> nextGame{0};
+    std::mutex outputMutex;
+    Tally total;
+
+    // Workers take game numbers from a shared counter; results are written as
+    // games finish, so lines are not in game order.
+    auto work = [&] {
+        // Random players reseed from the game number, so a game plays out the
+        // same whichever worker runs it.
+        const auto first = makePlayer(options.first, options, shared, options.seed);
+        const auto second = makePlayer(options.second, options, shared, options.seed + 1);
+        Tally tally;
+        std::vector<Board::Move> history;
+        std::string record;
+        std::string line;
+
+        for (std::uint64_t game = nextGame++; game < options.games; game = nextGame++)
+        {
+            first->newGame(game);
+            second->newGame(game);
+            int plies = 0;
+            const Outcome outcome = playGame(*first, *second, options.maxPlies, history, record, plies);
+
+            ++tally.games;
+            tally.plies += static_cast<std::uint64_t>(plies);
+            tally.firstWins += outcome == Outcome::FirstWins ? 1 : 0;
+            tally.secondWins += outcome == Outcome::SecondWins ? 1 : 0;
+            tally.draws += outcome == Outcome::Draw ? 1 : 0;
+
+            line = std::to_string(game) + ',' + first->name() + ',' + second->name() + ',' + outcomeName(outcome) + ','
+                 + std::to_string(plies) + ',' + record + '\n';
+            std::lock_guard lock(outputMutex);
+            out << line;
+            if (pdn.is_open())
+            {
+                Pdn::write(pdn,
+                           {{"Event", "runner"}, {"Round", std::to_string(game)}, {"Black", first->name()}, {"White", second->name()}},
+                           startPosition,
+                           history,
+                           pdnResult(outcome));
+            }
+        }
+
+        std::lock_guard lock(outputMutex);
+        total.games += tally.games;
+        total.firstWins += tally.firstWins;
+        total.secondWins += tally.secondWins;
+        total.draws += tally.draws;
+        total.plies += tally.plies;
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int i = 1; i < options.threads; ++i)
+    {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    reporter.reset();
+
+    const auto percent = [&total](std::uint64_t count) { return total.games ? 100.0 * count / total.games : 0.0; };
+    std::cout << std::fixed << std::setprecision(1) << total.games << " games (" << options.first << " vs "
+              << options.second << ") on " << options.threads << " threads in " << seconds << " s, "
+              << (seconds > 0 ? total.games / seconds : 0.0) << " games/sec\n"
+              << "first wins " << total.firstWins << " (" << percent(total.firstWins) << "%), second wins "
+              << total.secondWins << " (" << percent(total.secondWins) << "%), draws " << total.draws << " ("
+              << percent(total.draws) << "%)\n"
+              << "average length " << (total.games ? static_cast<double>(total.plies) / total.games : 0.0)
+              << " plies; results in " << options.output << '\n';
+    return out && (!pdn.is_open() || pdn) && (!statsOut.is_open() || statsOut) ? 0 : 1;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+
+            const std::string value = argv[++i];
+            if (arg == "--games")
+            {
+                options.games = std::stoull(value);
+            }
+            else if (arg == "--first" && isPlayerKind(value))
+            {
+                options.first = value;
+            }
+            else if (arg == "--second" && isPlayerKind(value))
+            {
+                options.second = value;
+            }
+            else if (arg == "--think-ms")
+            {
+                options.thinkMs = std::stoi(value);
+            }
+            else if (arg == "--depth")
+            {
+                options.depth = std::stoi(value);
+            }
+            else if (arg == "--threads")
+            {
+                options.threads = std::max(1, std::stoi(value));
+            }
+            else if (arg == "--max-plies")
+            {
+                options.maxPlies = std::stoi(value);
+            }
+            else if (arg == "--hash")
+            {
+                options.hashMegabytes = std::stoul(value);
+            }
+            else if (arg == "--seed")
+            {
+                options.seed = static_cast<std::uint32_t>(std::stoul(value));
+            }
+            else if (arg == "--script")
+            {
+                options.scriptPath = value;
+            }
+            else if (arg == "--book")
+            {
+                options.bookPath = value;
+            }
+            else if (arg == "--tablebase")
+            {
+                options.tablebasePath = value;
+            }
+            else if (arg == "--out")
+            {
+                options.output = value;
+            }
+            else if (arg == "--pdn")
+            {
+                options.pdnPath = value;
+            }
+            else if (arg == "--stats")
+            {
+                options.statsPath = value;
+            }
+            else if (arg == "--stats-format" && (value == "json" || value == "csv"))
+            {
+                options.statsFormat = value == "json" ? Stats::Format::Json : Stats::Format::Csv;
+            }
+            else if (arg == "--stats-interval-ms")
+            {
+                options.statsIntervalMs = std::stoi(value);
+            }
+            else
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+    }
+    catch (const std::exception&)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    return run(options);
+}
@@ -0,0 +1,166 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "Board.h"
+#include "Tablebase.h"
+#include "TablebaseGenerator.h"
+
+namespace
+{
+constexpr int DEFAULT_PIECES = 4;
+constexpr char DEFAULT_PATH[] = "checkers.tb";
+
+void printUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [--pieces N] [--out PATH]\n"
+              << "       " << program << " --verify PATH\n";
+}
+
+int generate(int pieces, const std::string& path)
+{
+    const auto start = std::chrono::steady_clock::now();
+    TablebaseGenerator generator(pieces);
+    generator.generate([](const Tablebase::Material& material, std::uint64_t positions) {
+        std::cout << material.firstMen << material.firstKings << material.secondMen << material.secondKings << "  "
+                  << positions << " positions\n";
+    });
+    if (!generator.write(path))
+    {
+        std::cerr << "Unable to write " << path << '\n';
+        return 1;
+    }
+
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "wrote " << path << " in " << seconds << " s\n";
+    return 0;
+}
+
+// Checks every stored result against the results of its successors, one ply deep.
+int verify(const std::string& path)
+{
+    Tablebase tablebase;
+    if (!tablebase.open(path))
+    {
+        std::cerr << "Unable to open " << path << '\n';
+        return 1;
+    }
+
+    using Outcome = Tablebase::Outcome;
+    const int maxPieces = tablebase.maxPieces();
+    std::uint64_t checked = 0;
+    std::uint64_t failures = 0;
+    Board board;
+    Board::MoveList moves;
+
+    for (int slot = 0; slot < static_cast<int>(Tablebase::slotCount(maxPieces)); ++slot)
+    {
+        const int base = maxPieces + 1;
+        const Tablebase::Material material{slot / (base * base * base), slot / (base * base) % base, slot / base % base,
+                                           slot % base};
+        if (Tablebase::slotOf(material, maxPieces) != slot)
+        {
+            continue;
+        }
+
+        for (std::uint64_t index = 0; index < Tablebase::sliceSize(material); ++index)
+        {
+            if (!Tablebase::positionAt(material, index, board))
+            {
+                continue;
+            }
+
+            bool anyLoss = false;
+            bool anyDraw = false;
+            int fastestWin = Tablebase::MAX_DISTANCE;
+            int longestLoss = 0;
+            board.getLegalMoves(board.sideToMove(), moves);
+            for (const auto& move : moves)
+            {
+                const Board::Undo undo = board.makeMove(move);
+                const auto child = board.piecesOf(board.sideToMove()) == 0
+                    ? Tablebase::Result{Outcome::Loss, 0}
+                    : tablebase.probe(board).value_or(Tablebase::Result{});
+                board.unmakeMove(undo);
+
+                if (child.outcome == Outcome::Loss)
+                {
+                    anyLoss = true;
+                    fastestWin = std::min(fastestWin, child.distance + 1);
+                }
+                else if (child.outcome == Outcome::Draw)
+                {
+                    anyDraw = true;
+                }
+                else
+                {
+                    longestLoss = std::max(longestLoss, std::min(child.distance + 1, Tablebase::MAX_DISTANCE));
+                }
+            }
+
+            const auto stored = tablebase.probe(board).value_or(Tablebase::Result{});
+            const Tablebase::Result expected = anyLoss ? Tablebase::Result{Outcome::Win, fastestWin}
+                                             : anyDraw ? Tablebase::Result{Outcome::Draw, 0}
+                                                       : Tablebase::Result{Outcome::Loss, longestLoss};
+            ++checked;
+            if (stored.outcome != expected.outcome || stored.distance != expected.distance)
+            {
+                ++failures;
+            }
+        }
+    }
+
+    std::cout << "checked " << checked << " positions, " << failures << " inconsistent\n";
+    return failures == 0 ? 0 : 1;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    int pieces = DEFAULT_PIECES;
+    std::string path = DEFAULT_PATH;
+
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+            if (arg == "--pieces")
+            {
+                pieces = std::stoi(argv[++i]);
+            }
+            else if (arg == "--out")
+            {
+                path = argv[++i];
+            }
+            else if (arg == "--verify")
+            {
+                return verify(argv[++i]);
+            }
+            else
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+    }
+    catch (const std::exception&)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (pieces < 2 || pieces > 2 * Board::PIECES_PER_SIDE)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    return generate(pieces, path);
+}